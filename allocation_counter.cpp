@@ -0,0 +1,89 @@
+#include "allocation_counter.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    thread_local std::uint64_t threadAllocations = 0;
+    std::atomic<std::uint64_t> processAllocations{0};
+
+    void countAllocation()
+    {
+        ++threadAllocations;
+        processAllocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+std::uint64_t AllocationCounter::thisThread()
+{
+    return threadAllocations;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::uint64_t AllocationCounter::process()
+{
+    return processAllocations.load(std::memory_order_relaxed);
+}
+
+//------------------------------------------------------------------------------------------
+
+// GCC pairs the library's operator new with free() here and warns, not seeing it replaced
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size)
+{
+    countAllocation();
+
+    if (void* memory = std::malloc(std::max<std::size_t>(size, 1)))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    countAllocation();
+
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    // aligned_alloc wants the size to be a multiple of the alignment
+    const std::size_t rounded = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+
+    #ifdef _WIN32
+        void* memory = _aligned_malloc(rounded, align);
+    #else
+        void* memory = std::aligned_alloc(align, rounded);
+    #endif
+
+    if (memory)
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+#ifdef _WIN32
+    void operator delete(void* memory, std::align_val_t) noexcept { _aligned_free(memory); }
+#else
+    void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+#endif
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept { operator delete(memory, alignment); }
+void operator delete[](void* memory, std::align_val_t alignment) noexcept { operator delete(memory, alignment); }
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept { operator delete(memory, alignment); }
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------
+
+// Counts the allocations made through operator new. Linking allocation_counter.cpp into a
+// program replaces the global operator new and delete with ones that count, both for the
+// calling thread and over the whole process; the tools that measure allocations link it,
+// the solver itself does not.
+
+class AllocationCounter
+{
+public:
+    // Allocations made so far on the calling thread
+    static std::uint64_t thisThread();
+    // Allocations made so far on every thread
+    static std::uint64_t process();
+};
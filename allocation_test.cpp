@@ -0,0 +1,301 @@
+#include "allocation_counter.hpp"
+#include "iterative_solver.hpp"
+#include "mapped_file.hpp"
+#include "puzzle_scanner.hpp"
+#include "sudoku.hpp"
+#include "sudoku_batch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------
+
+// Checks that solving allocates nothing once each thread's solvers are built: a stream of
+// puzzles is solved with every strategy on one reused board, then files of two sizes are
+// solved with --batch, which must allocate the same amount for both. Also checks that the
+// iterative solver, stopped and resumed every few steps, ends where one full run does.
+// Exits non-zero on the first failure.
+
+static const std::vector<std::string> corpusPaths =
+{
+    "sudoku_examples/generated_easy.txt",
+    "sudoku_examples/generated_medium.txt",
+    "sudoku_examples/generated_hard.txt",
+    "sudoku_examples/generated_hardest.txt"
+};
+
+static const std::vector<Sudoku::SolverStrategy> allStrategies =
+{
+    Sudoku::SolverStrategy::DepthFirst,
+    Sudoku::SolverStrategy::Propagation,
+    Sudoku::SolverStrategy::DancingLinks,
+    Sudoku::SolverStrategy::Iterative,
+    Sudoku::SolverStrategy::Deduction
+};
+
+// Puzzles taken from each corpus for the solver stream; the depth-first solver is slow on
+// the hardest ones
+constexpr int PuzzlesPerCorpus = 100;
+
+// Steps per run of the iterative solver in the resumed solves; small and odd, so the
+// search stops in every kind of state
+constexpr std::uint64_t SliceSteps = 7;
+
+// Puzzles in the smaller --batch file; the larger one holds ten times as many
+constexpr int BatchPuzzles = 10000;
+
+// Swallows the --batch output
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+//------------------------------------------------------------------------------------------
+
+// Returns false if a file cannot be read or holds a malformed puzzle
+static bool loadPuzzles(std::vector<Sudoku>& puzzles)
+{
+    for (const std::string& path : corpusPaths)
+    {
+        MappedFile file;
+
+        if (!file.open(path))
+        {
+            std::cerr << "Error opening file '" << path << "'. \n";
+            return false;
+        }
+
+        PuzzleScanner scanner(file.view(), PuzzleFormat::Line);
+        Sudoku sudoku;
+
+        for (int i = 0; i < PuzzlesPerCorpus; ++i)
+        {
+            const PuzzleScanner::Result result = scanner.next(sudoku);
+
+            if (result == PuzzleScanner::Result::End)
+            {
+                break;
+            }
+            if (result == PuzzleScanner::Result::Error)
+            {
+                std::cerr << "Error reading '" << path << "': " << scanner.error().message << ". \n";
+                return false;
+            }
+            puzzles.push_back(sudoku);
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+// Solves and counts the solutions of every puzzle with every strategy on one board.
+// Returns false if one is not solved or has more than one solution.
+static bool solveAll(const std::vector<Sudoku>& puzzles)
+{
+    Sudoku sudoku;
+    SolverStats stats;
+
+    for (Sudoku::SolverStrategy strategy : allStrategies)
+    {
+        for (const Sudoku& puzzle : puzzles)
+        {
+            sudoku = puzzle;
+            sudoku.setSolverStrategy(strategy);
+
+            if (sudoku.countSolutions(2) != 1)
+            {
+                return false;
+            }
+
+            stats = SolverStats{};
+            if (!sudoku.solve(stats))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+static bool sameStats(const SolverStats& a, const SolverStats& b)
+{
+    return (a.guesses == b.guesses) && (a.backtracks == b.backtracks) && (a.nodes == b.nodes)
+           && (a.placements == b.placements) && (a.maxDepth == b.maxDepth) && (a.propagationSteps == b.propagationSteps);
+}
+
+//------------------------------------------------------------------------------------------
+
+// Solves every puzzle with the iterative solver in slices of SliceSteps, and once in a
+// single run. Returns false if the two differ in solution or statistics.
+static bool solveInSlices(const std::vector<Sudoku>& puzzles, std::uint64_t& yields)
+{
+    IterativeSolver solver;
+
+    for (const Sudoku& puzzle : puzzles)
+    {
+        Sudoku whole = puzzle;
+        SolverStats wholeStats;
+
+        if (!solver.solve(whole, wholeStats))
+        {
+            return false;
+        }
+
+        solver.load(puzzle);
+        SolverStats slicedStats;
+        IterativeSolver::Status status;
+
+        while ((status = solver.run(SliceSteps, slicedStats)) == IterativeSolver::Status::Yielded)
+        {
+            ++yields;
+        }
+        if (status != IterativeSolver::Status::Solved)
+        {
+            return false;
+        }
+
+        Sudoku sliced = puzzle;
+        solver.writeSolution(sliced);
+
+        if (!std::equal(sliced.cells(), sliced.cells() + Sudoku::CellCount, whole.cells())
+            || !sameStats(slicedStats, wholeStats))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+// Writes count puzzles to path, cycling through the corpora
+static bool writeBatchFile(const std::vector<Sudoku>& puzzles, const std::string& path, int count)
+{
+    std::ofstream file(path, std::ios::binary);
+    char line[Sudoku::LineLength + 1];
+    line[Sudoku::LineLength] = '\n';
+
+    for (int i = 0; i < count; ++i)
+    {
+        puzzles[static_cast<std::size_t>(i) % puzzles.size()].writeToLine(line);
+        file.write(line, sizeof(line));
+    }
+    return file.good();
+}
+
+//------------------------------------------------------------------------------------------
+
+// Returns the allocations made by a whole --batch run over the file
+static std::uint64_t measureBatch(const std::string& path, int& status)
+{
+    const std::uint64_t before = AllocationCounter::process();
+    {
+        SudokuBatch batch;
+        batch.setInputPath(path);
+        batch.setThreadCount(2);
+        status = batch.exec();
+    }
+    return AllocationCounter::process() - before;
+}
+
+//------------------------------------------------------------------------------------------
+
+int main()
+{
+    std::vector<Sudoku> puzzles;
+
+    if (!loadPuzzles(puzzles) || puzzles.empty())
+    {
+        return 1;
+    }
+
+    // Builds this thread's solvers
+    if (!solveAll({ puzzles.front() }))
+    {
+        std::cerr << "FAIL: a puzzle was not solved uniquely. \n";
+        return 1;
+    }
+
+    const std::uint64_t before = AllocationCounter::process();
+    const bool solved = solveAll(puzzles);
+    const std::uint64_t solveAllocations = AllocationCounter::process() - before;
+
+    if (!solved)
+    {
+        std::cerr << "FAIL: a puzzle was not solved uniquely. \n";
+        return 1;
+    }
+    std::cerr << puzzles.size() * allStrategies.size() << " solves and solution counts made "
+              << solveAllocations << " allocations. \n";
+
+    if (solveAllocations != 0)
+    {
+        std::cerr << "FAIL: solving allocated after warm-up. \n";
+        return 1;
+    }
+
+    std::uint64_t yields = 0;
+
+    if (!solveInSlices(puzzles, yields))
+    {
+        std::cerr << "FAIL: the iterative solver resumed in slices of " << SliceSteps
+                  << " steps did not match a single run. \n";
+        return 1;
+    }
+    std::cerr << "Iterative solves in slices of " << SliceSteps << " steps yielded " << yields
+              << " times and matched single runs. \n";
+
+    const std::filesystem::path directory = std::filesystem::temp_directory_path();
+    const std::string smallPath = (directory / "allocation_test_small.txt").string();
+    const std::string largePath = (directory / "allocation_test_large.txt").string();
+
+    if (!writeBatchFile(puzzles, smallPath, BatchPuzzles) || !writeBatchFile(puzzles, largePath, 10 * BatchPuzzles))
+    {
+        std::cerr << "Error writing the --batch files in '" << directory.string() << "'. \n";
+        return 1;
+    }
+
+    // --batch turns this off too, which replaces the stream buffers the first time; doing it
+    // here keeps the null buffer in place and the replacement out of the counts
+    std::ios::sync_with_stdio(false);
+
+    NullBuffer nullBuffer;
+    std::streambuf* const output = std::cout.rdbuf(&nullBuffer);
+
+    int smallStatus = 0;
+    int largeStatus = 0;
+    const std::uint64_t smallAllocations = measureBatch(smallPath, smallStatus);
+    const std::uint64_t largeAllocations = measureBatch(largePath, largeStatus);
+
+    std::cout.rdbuf(output);
+    std::filesystem::remove(smallPath);
+    std::filesystem::remove(largePath);
+
+    std::cerr << "--batch made " << smallAllocations << " allocations for " << BatchPuzzles << " puzzles and "
+              << largeAllocations << " for " << 10 * BatchPuzzles << ". \n";
+
+    if ((smallStatus != 0) || (largeStatus != 0))
+    {
+        std::cerr << "FAIL: --batch did not solve every puzzle. \n";
+        return 1;
+    }
+    if (largeAllocations != smallAllocations)
+    {
+        std::cerr << "FAIL: --batch allocations grow with the number of puzzles. \n";
+        return 1;
+    }
+
+    std::cerr << "PASS \n";
+    return 0;
+}
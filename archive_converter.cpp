@@ -0,0 +1,223 @@
+#include "archive_converter.hpp"
+
+#include "mapped_file.hpp"
+#include "puzzle_archive.hpp"
+#include "puzzle_scanner.hpp"
+
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+
+//------------------------------------------------------------------------------------------
+
+bool ArchiveConverter::readInput(const std::string& path, MappedFile& mappedInput, std::string& stdinInput, std::string_view& input)
+{
+    if (path == "-")
+    {
+        stdinInput.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+        input = stdinInput;
+        return true;
+    }
+    if (mappedInput.open(path))
+    {
+        input = mappedInput.view();
+        return true;
+    }
+
+    std::cerr << "Error opening file '" << path << "'. \n";
+    return false;
+}
+
+//------------------------------------------------------------------------------------------
+
+int ArchiveConverter::pack(const std::string& inputPath, const std::string& archivePath)
+{
+    MappedFile mappedInput;
+    std::string stdinInput;
+    std::string_view input;
+
+    if (!readInput(inputPath, mappedInput, stdinInput, input))
+    {
+        return 1;
+    }
+
+    PuzzleArchiveWriter writer;
+
+    if (!writer.open(archivePath, solutions, writeIndex))
+    {
+        std::cerr << "Error creating file '" << archivePath << "'. \n";
+        return 1;
+    }
+
+    PuzzleScanner scanner(input, PuzzleScanner::detectFormat(input));
+    Sudoku puzzle;
+    puzzle.setSolverStrategy(solverStrategy);
+    long long failed = 0;
+
+    SolverStats stats;
+    stats.recordDepthHistogram = showStats;
+
+    for (auto result = scanner.next(puzzle); result != PuzzleScanner::Result::End; result = scanner.next(puzzle))
+    {
+        if (result == PuzzleScanner::Result::Error)
+        {
+            const ParseError& error = scanner.error();
+            std::cerr << "Byte " << error.offset << " (line " << error.line << "): " << error.message << ". \n";
+            ++failed;
+            continue;
+        }
+
+        if (!solutions)
+        {
+            writer.add(puzzle);
+            continue;
+        }
+
+        Sudoku solution = puzzle;
+
+        if (!(showStats ? solution.solve(stats) : solution.solve()))
+        {
+            std::cerr << "Line " << scanner.recordLine() << ": puzzle has no solution. \n";
+            ++failed;
+            continue;
+        }
+        writer.add(puzzle, &solution);
+    }
+
+    if (!writer.close())
+    {
+        std::cerr << "Error writing file '" << archivePath << "'. \n";
+        return 1;
+    }
+
+    std::cerr << "Packed " << writer.recordCount() << " puzzles into '" << archivePath << "'. \n";
+
+    if (showStats && solutions)
+    {
+        std::cerr << "Solver statistics over all puzzles: \n" << stats;
+    }
+    return (failed == 0) ? 0 : 1;
+}
+
+//------------------------------------------------------------------------------------------
+
+int ArchiveConverter::unpack(const std::string& archivePath)
+{
+    std::ios::sync_with_stdio(false);
+
+    PuzzleArchive archive;
+
+    if (!archive.open(archivePath))
+    {
+        return 1;
+    }
+
+    if (solutions && !archive.hasSolutions())
+    {
+        std::cerr << "Archive '" << archivePath << "' holds no solutions. \n";
+        return 1;
+    }
+
+    if (!findPath.empty())
+    {
+        return unpackFound(archive);
+    }
+
+    Sudoku sudoku;
+    std::string output;
+    long long failed = 0;
+
+    for (std::size_t record = 0; record < archive.size(); ++record)
+    {
+        const std::size_t offset = output.size();
+        output.resize(offset + Sudoku::LineLength);
+
+        if (sudoku.loadPacked(archive.givens(record), solutions ? archive.solution(record) : nullptr))
+        {
+            sudoku.writeToLine(output.data() + offset);
+        }
+        else
+        {
+            std::cerr << "Record " << record << ": value out of range. \n";
+            output.replace(offset, Sudoku::LineLength, Sudoku::LineLength, '.');
+            ++failed;
+        }
+        output += '\n';
+
+        if (output.size() >= (1 << 16))
+        {
+            std::cout << output;
+            output.clear();
+        }
+    }
+    std::cout << output << std::flush;
+
+    return (failed == 0) ? 0 : 1;
+}
+
+//------------------------------------------------------------------------------------------
+
+int ArchiveConverter::unpackFound(const PuzzleArchive& archive)
+{
+    MappedFile mappedInput;
+    std::string stdinInput;
+    std::string_view input;
+
+    if (!readInput(findPath, mappedInput, stdinInput, input))
+    {
+        return 1;
+    }
+
+    if (!archive.hasIndex())
+    {
+        std::cerr << "The archive has no index, so every lookup scans it; pack it with --index to avoid that. \n";
+    }
+
+    PuzzleScanner scanner(input, PuzzleScanner::detectFormat(input));
+    Sudoku puzzle;
+    Sudoku sudoku;
+    std::string output;
+    long long found = 0;
+    long long failed = 0;
+
+    for (auto result = scanner.next(puzzle); result != PuzzleScanner::Result::End; result = scanner.next(puzzle))
+    {
+        if (result == PuzzleScanner::Result::Error)
+        {
+            const ParseError& error = scanner.error();
+            std::cerr << "Byte " << error.offset << " (line " << error.line << "): " << error.message << ". \n";
+            ++failed;
+            continue;
+        }
+
+        const std::size_t offset = output.size();
+        output.resize(offset + Sudoku::LineLength);
+
+        const std::optional<std::size_t> record = archive.find(puzzle);
+
+        if (record && sudoku.loadPacked(archive.givens(*record), solutions ? archive.solution(*record) : nullptr))
+        {
+            sudoku.writeToLine(output.data() + offset);
+            ++found;
+        }
+        else
+        {
+            std::cerr << "Line " << scanner.recordLine() << ": puzzle is not in the archive. \n";
+            puzzle.writeToLine(output.data() + offset);
+            ++failed;
+        }
+        output += '\n';
+
+        if (output.size() >= (1 << 16))
+        {
+            std::cout << output;
+            output.clear();
+        }
+    }
+    std::cout << output << std::flush;
+
+    std::cerr << "Found " << found << " of " << (found + failed) << " puzzles. \n";
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "sudoku.hpp"
+
+#include <string>
+#include <string_view>
+
+class MappedFile;
+class PuzzleArchive;
+
+//------------------------------------------------------------------------------------------
+
+// Converts between the text formats and the binary puzzle archive. Packing reads 9-row CSV
+// boards or single-line puzzles (detected from the first line), optionally solving each to
+// store its solution; bad or unsolvable puzzles are reported on stderr and left out.
+// Unpacking writes every record to stdout in the single-line format, or with a find path,
+// only the records holding the puzzles of that file, looked up through the archive's index.
+
+class ArchiveConverter
+{
+public:
+    // Both return the process exit code: 0 on success, 1 if anything failed
+    int pack(const std::string& inputPath, const std::string& archivePath);
+    int unpack(const std::string& archivePath);
+
+    void setSolverStrategy(Sudoku::SolverStrategy strategy) { solverStrategy = strategy; }
+    // Packing stores solutions; unpacking writes them instead of the puzzles
+    void setSolutions(bool status) { solutions = status; }
+    void setWriteIndex(bool status) { writeIndex = status; }
+    // Packing with solutions prints solver statistics over every solve
+    void setShowStats(bool status) { showStats = status; }
+    // Puzzles, in either text format, whose records unpacking writes; empty for every record
+    void setFindPath(const std::string& path) { findPath = path; }
+
+private:
+    // Writes the record of each puzzle of findPath in turn, echoing the puzzles that are not
+    // in the archive and reporting them on stderr
+    int unpackFound(const PuzzleArchive&);
+
+    // Maps the file, or reads all of stdin for "-"; returns false if it cannot be opened
+    static bool readInput(const std::string& path, MappedFile&, std::string& stdinInput, std::string_view& input);
+
+    Sudoku::SolverStrategy solverStrategy = Sudoku::SolverStrategy::Propagation;
+    bool solutions = false;
+    bool writeIndex = false;
+    bool showStats = false;
+    std::string findPath;
+};
@@ -0,0 +1,665 @@
+// Benchmarks every solver backend on the example boards and bundled corpora, then the lane
+// solver on the same corpora, writing the results to stdout as JSON so runs from different
+// versions can be compared.
+
+#include "allocation_counter.hpp"
+#include "lane_solver.hpp"
+#include "mapped_file.hpp"
+#include "perf_counters.hpp"
+#include "puzzle_scanner.hpp"
+#include "solver_stats.hpp"
+#include "sudoku.hpp"
+#include "sudoku_validator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------
+
+struct Backend
+{
+    const char* name;
+    Sudoku::SolverStrategy strategy;
+};
+
+static const std::vector<Backend> allBackends =
+{
+    {"depth",       Sudoku::SolverStrategy::DepthFirst},
+    {"propagation", Sudoku::SolverStrategy::Propagation},
+    {"dlx",         Sudoku::SolverStrategy::DancingLinks},
+    {"iterative",   Sudoku::SolverStrategy::Iterative},
+    {"deduction",   Sudoku::SolverStrategy::Deduction}
+};
+
+static const std::vector<std::string> defaultCorpora =
+{
+    "sudoku_examples/easy.csv",
+    "sudoku_examples/medium.csv",
+    "sudoku_examples/hard.csv",
+    "sudoku_examples/worlds_hardest.csv",
+    "sudoku_examples/generated_easy.txt",
+    "sudoku_examples/generated_medium.txt",
+    "sudoku_examples/generated_hard.txt",
+    "sudoku_examples/generated_hardest.txt",
+    "sudoku_examples/famous_hard.txt"
+};
+
+struct Corpus
+{
+    std::string path;
+    std::vector<Sudoku> puzzles;
+};
+
+struct Options
+{
+    std::vector<std::string> corpusPaths;
+    std::vector<Backend> backends;
+    // Puzzles taken from the start of each corpus, 0 for all of them
+    int puzzleLimit = 100;
+    int maxThreads = 1;
+    // Read the hardware counters around each phase of every puzzle, and write each reading
+    // to countersPath if it is set
+    bool counters = false;
+    std::string countersPath;
+};
+
+// Steps of one puzzle's trip through the solver, each read on the counters on its own
+enum class Phase
+{
+    Parse,
+    Solve,
+    Validate,
+    Render,
+};
+
+constexpr int PhaseCount = 4;
+
+static const std::array<const char*, PhaseCount> phaseNames = {"parse", "solve", "validate", "render"};
+
+// JSON and CSV names of the counter events, in PerfCounters::Event order
+static const std::array<const char*, PerfCounters::EventCount> eventFields =
+{
+    "cycles", "instructions", "branch_misses", "l1_misses", "llc_misses"
+};
+
+//------------------------------------------------------------------------------------------
+
+static void printUsage(std::ostream& os)
+{
+    os << "Usage: ./benchmark [--corpus <file>]... [--solver depth|propagation|dlx|iterative|deduction]... [--puzzles N] [--threads N] \n"
+       << "                   [--counters] [--counters-csv <file>] \n"
+       << "  --corpus  Puzzle file in either format; may be repeated (default: sudoku_examples/). \n"
+       << "  --solver  Backend to measure; may be repeated (default: all). \n"
+       << "  --puzzles Puzzles taken from each corpus, 0 for all (default: 100). \n"
+       << "  --threads Highest thread count of the throughput sweep (default: all cores). \n"
+       << "  --counters Read cycles, instructions, branch and cache misses around each phase of every puzzle (Linux). \n"
+       << "  --counters-csv Also write every reading to a CSV file, one line per puzzle and phase. \n";
+}
+
+//------------------------------------------------------------------------------------------
+
+// Returns true if text is a whole integer no smaller than minimum
+static bool parseInt(const std::string& text, int minimum, int& value)
+{
+    try
+    {
+        std::size_t parsedLength = 0;
+        value = std::stoi(text, &parsedLength);
+        return (parsedLength == text.size()) && (value >= minimum);
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+static bool parseOptions(int argc, char* argv[], Options& options)
+{
+    options.maxThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = (i + 1 < argc);
+
+        if ((argument == "--corpus") && hasValue)
+        {
+            options.corpusPaths.push_back(argv[++i]);
+        }
+        else if ((argument == "--solver") && hasValue)
+        {
+            const std::string name = argv[++i];
+            const auto backendIt = std::find_if(allBackends.begin(), allBackends.end(),
+                                                [&name](const Backend& backend) { return name == backend.name; });
+
+            if (backendIt == allBackends.end())
+            {
+                std::cerr << "Unknown solver '" << name << "'. \n";
+                return false;
+            }
+            options.backends.push_back(*backendIt);
+        }
+        else if ((argument == "--puzzles") && hasValue)
+        {
+            if (!parseInt(argv[++i], 0, options.puzzleLimit))
+            {
+                std::cerr << "Puzzle count must be a non-negative integer. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--threads") && hasValue)
+        {
+            if (!parseInt(argv[++i], 1, options.maxThreads))
+            {
+                std::cerr << "Thread count must be a positive integer. \n";
+                return false;
+            }
+        }
+        else if (argument == "--counters")
+        {
+            options.counters = true;
+        }
+        else if ((argument == "--counters-csv") && hasValue)
+        {
+            options.counters = true;
+            options.countersPath = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Unrecognised argument '" << argument << "'. \n";
+            return false;
+        }
+    }
+
+    if (options.corpusPaths.empty())
+    {
+        options.corpusPaths = defaultCorpora;
+    }
+    if (options.backends.empty())
+    {
+        options.backends = allBackends;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+// Returns false if the file cannot be read or holds a malformed puzzle
+static bool loadCorpus(const std::string& path, int limit, Corpus& corpus)
+{
+    MappedFile file;
+
+    if (!file.open(path))
+    {
+        std::cerr << "Error opening file '" << path << "'. \n";
+        return false;
+    }
+
+    PuzzleScanner scanner(file.view(), PuzzleScanner::detectFormat(file.view()));
+    Sudoku sudoku;
+
+    corpus.path = path;
+
+    while ((limit == 0) || (static_cast<int>(corpus.puzzles.size()) < limit))
+    {
+        const PuzzleScanner::Result result = scanner.next(sudoku);
+
+        if (result == PuzzleScanner::Result::End)
+        {
+            break;
+        }
+        if (result == PuzzleScanner::Result::Error)
+        {
+            const ParseError& error = scanner.error();
+            std::cerr << "Error reading '" << path << "' at byte " << error.offset
+                      << " (line " << error.line << "): " << error.message << ". \n";
+            return false;
+        }
+        corpus.puzzles.push_back(sudoku);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+static std::string jsonString(const std::string& text)
+{
+    std::string quoted = "\"";
+
+    for (char c : text)
+    {
+        if ((c == '"') || (c == '\\'))
+        {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + '"';
+}
+
+//------------------------------------------------------------------------------------------
+
+// Value at fraction of the way through sorted values, 0 if there are none
+static double percentile(const std::vector<double>& sorted, double fraction)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+    const std::size_t index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+//------------------------------------------------------------------------------------------
+
+// Writes the counts of a reading per puzzle, null for events that are not counted, then
+// IPC and misses per thousand instructions over the whole reading
+static void writeCounters(const PerfCounters& counters, const PerfCounters::Reading& reading, double count, std::ostream& os)
+{
+    using Event = PerfCounters::Event;
+
+    for (int e = 0; e < PerfCounters::EventCount; ++e)
+    {
+        const Event event = static_cast<Event>(e);
+        os << "\"" << eventFields[e] << "\": ";
+
+        if (counters.has(event))
+        {
+            os << (static_cast<double>(reading[event]) / count);
+        }
+        else
+        {
+            os << "null";
+        }
+        os << ", ";
+    }
+
+    const bool perInstruction = counters.has(Event::Instructions);
+    const auto writeRatio = [&os](const char* field, bool available, double value)
+    {
+        os << "\"" << field << "\": ";
+        if (available)
+        {
+            os << value;
+        }
+        else
+        {
+            os << "null";
+        }
+    };
+
+    writeRatio("ipc", perInstruction && counters.has(Event::Cycles), reading.ipc());
+    os << ", ";
+    writeRatio("branch_mpki", perInstruction && counters.has(Event::BranchMisses), reading.perKiloInstruction(Event::BranchMisses));
+    os << ", ";
+    writeRatio("l1_mpki", perInstruction && counters.has(Event::L1Misses), reading.perKiloInstruction(Event::L1Misses));
+    os << ", ";
+    writeRatio("llc_mpki", perInstruction && counters.has(Event::LlcMisses), reading.perKiloInstruction(Event::LlcMisses));
+}
+
+//------------------------------------------------------------------------------------------
+
+// Takes each puzzle of the corpus through parsing its line, solving, validating the result
+// and rendering the board, reading the counters around each phase. Writes the readings per
+// puzzle to perPuzzle if it is set, then the totals per phase to os, with the spread of the
+// IPC between puzzles. Kept apart from the timed run, as starting and stopping the counters
+// costs a few system calls per phase.
+static void profileCorpus(const Backend& backend, const Corpus& corpus, PerfCounters& counters,
+                          std::ostream* perPuzzle, std::ostream& os)
+{
+    std::array<PerfCounters::Reading, PhaseCount> totals{};
+    std::array<std::vector<double>, PhaseCount> ipcs;
+    std::vector<char> rendering(Sudoku::MaxRenderLength);
+    std::array<char, Sudoku::LineLength> line{};
+    std::size_t valid = 0;
+
+    for (std::size_t p = 0; p < corpus.puzzles.size(); ++p)
+    {
+        corpus.puzzles[p].writeToLine(line.data());
+
+        std::array<PerfCounters::Reading, PhaseCount> readings;
+        Sudoku sudoku;
+
+        counters.start();
+        PuzzleScanner scanner({ line.data(), line.size() }, PuzzleFormat::Line);
+        scanner.next(sudoku);
+        readings[static_cast<int>(Phase::Parse)] = counters.stop();
+
+        sudoku.setSolverStrategy(backend.strategy);
+
+        counters.start();
+        sudoku.solve();
+        readings[static_cast<int>(Phase::Solve)] = counters.stop();
+
+        counters.start();
+        const BoardCheck check = SudokuValidator::check(sudoku.cells());
+        readings[static_cast<int>(Phase::Validate)] = counters.stop();
+
+        counters.start();
+        sudoku.render(rendering.data(), Sudoku::RenderStyle::Plain);
+        readings[static_cast<int>(Phase::Render)] = counters.stop();
+
+        valid += check.done() ? 1 : 0;
+
+        for (int phase = 0; phase < PhaseCount; ++phase)
+        {
+            const PerfCounters::Reading& reading = readings[phase];
+            totals[phase] += reading;
+            ipcs[phase].push_back(reading.ipc());
+
+            if (perPuzzle != nullptr)
+            {
+                *perPuzzle << backend.name << ',' << corpus.path << ',' << p << ',' << phaseNames[phase];
+                for (int e = 0; e < PerfCounters::EventCount; ++e)
+                {
+                    *perPuzzle << ',';
+                    if (counters.has(static_cast<PerfCounters::Event>(e)))
+                    {
+                        *perPuzzle << reading.counts[e];
+                    }
+                }
+                *perPuzzle << ',' << reading.ipc() << '\n';
+            }
+        }
+    }
+
+    const double count = static_cast<double>(std::max<std::size_t>(corpus.puzzles.size(), 1));
+    const bool hasIpc = counters.has(PerfCounters::Event::Cycles) && counters.has(PerfCounters::Event::Instructions);
+
+    os << "{\"valid\": " << valid;
+
+    for (int phase = 0; phase < PhaseCount; ++phase)
+    {
+        std::vector<double>& ipc = ipcs[phase];
+        std::sort(ipc.begin(), ipc.end());
+
+        os << ",\n          \"" << phaseNames[phase] << "\": {";
+        writeCounters(counters, totals[phase], count, os);
+
+        if (hasIpc)
+        {
+            os << ", \"ipc_per_puzzle\": {\"p10\": " << percentile(ipc, 0.10)
+               << ", \"p50\": " << percentile(ipc, 0.50)
+               << ", \"p90\": " << percentile(ipc, 0.90) << "}";
+        }
+        os << "}";
+    }
+    os << "}";
+}
+
+//------------------------------------------------------------------------------------------
+
+// Solves each puzzle of the corpus in turn on this thread, timing them one at a time. With
+// counters, the corpus is then profiled phase by phase as well.
+static void benchmarkCorpus(const Backend& backend, const Corpus& corpus, PerfCounters* counters,
+                            std::ostream* perPuzzle, std::ostream& os)
+{
+    std::vector<double> nanoseconds;
+    nanoseconds.reserve(corpus.puzzles.size());
+
+    std::uint64_t guesses = 0;
+    std::uint64_t allocations = 0;
+    std::size_t solved = 0;
+
+    for (const Sudoku& puzzle : corpus.puzzles)
+    {
+        Sudoku sudoku = puzzle;
+        sudoku.setSolverStrategy(backend.strategy);
+        SolverStats stats;
+
+        const std::uint64_t allocationsBefore = AllocationCounter::thisThread();
+        const auto start = std::chrono::steady_clock::now();
+
+        solved += sudoku.solve(stats) ? 1 : 0;
+
+        const auto finish = std::chrono::steady_clock::now();
+        allocations += AllocationCounter::thisThread() - allocationsBefore;
+        guesses += stats.guesses;
+
+        nanoseconds.push_back(std::chrono::duration<double, std::nano>(finish - start).count());
+    }
+
+    const double count = static_cast<double>(std::max<std::size_t>(corpus.puzzles.size(), 1));
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+
+    double total = 0;
+    for (double ns : nanoseconds)
+    {
+        total += ns;
+    }
+
+    os << "        {\"corpus\": " << jsonString(corpus.path)
+       << ", \"puzzles\": " << corpus.puzzles.size()
+       << ", \"solved\": " << solved
+       << ", \"ns_per_puzzle\": {\"mean\": " << (total / count)
+       << ", \"p50\": " << percentile(nanoseconds, 0.50)
+       << ", \"p90\": " << percentile(nanoseconds, 0.90)
+       << ", \"p99\": " << percentile(nanoseconds, 0.99)
+       << ", \"max\": " << percentile(nanoseconds, 1.0) << "}"
+       << ", \"guesses_per_puzzle\": " << (static_cast<double>(guesses) / count)
+       << ", \"allocations_per_puzzle\": " << (static_cast<double>(allocations) / count);
+
+    if ((counters != nullptr) && counters->isOpen())
+    {
+        os << ",\n          \"counters\": ";
+        profileCorpus(backend, corpus, *counters, perPuzzle, os);
+    }
+    os << "}";
+}
+
+//------------------------------------------------------------------------------------------
+
+// Solves the whole corpus at once with LaneSolver, the lanes handing what they cannot finish
+// to the propagation solver
+static void benchmarkLanes(const Corpus& corpus, std::ostream& os)
+{
+    std::vector<Sudoku> boards = corpus.puzzles;
+    for (Sudoku& sudoku : boards)
+    {
+        sudoku.setSolverStrategy(Sudoku::SolverStrategy::Propagation);
+    }
+    std::vector<Sudoku> finished = boards;
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t solved = LaneSolver::solve(boards.data(), boards.size());
+    const auto finish = std::chrono::steady_clock::now();
+
+    const std::size_t finishedInLanes = LaneSolver::propagate(finished.data(), finished.size());
+    const double count = static_cast<double>(std::max<std::size_t>(corpus.puzzles.size(), 1));
+
+    os << "        {\"corpus\": " << jsonString(corpus.path)
+       << ", \"puzzles\": " << corpus.puzzles.size()
+       << ", \"solved\": " << solved
+       << ", \"finished_in_lanes\": " << finishedInLanes
+       << ", \"ns_per_puzzle\": " << (std::chrono::duration<double, std::nano>(finish - start).count() / count) << "}";
+}
+
+//------------------------------------------------------------------------------------------
+
+// Solves every puzzle of every corpus once, spread over threadCount threads
+static double measureThroughput(const Backend& backend, const std::vector<const Sudoku*>& puzzles, int threadCount)
+{
+    std::atomic<std::size_t> nextPuzzle{0};
+
+    const auto work = [&]()
+    {
+        for (std::size_t index = nextPuzzle++; index < puzzles.size(); index = nextPuzzle++)
+        {
+            Sudoku sudoku = *puzzles[index];
+            sudoku.setSolverStrategy(backend.strategy);
+            sudoku.solve();
+        }
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(work);
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(puzzles.size()) / std::max(elapsed.count(), 1e-9);
+}
+
+//------------------------------------------------------------------------------------------
+
+// 1, 2, 4, ... up to and including maxThreads
+static std::vector<int> threadSweep(int maxThreads)
+{
+    std::vector<int> counts;
+
+    for (int count = 1; count < maxThreads; count *= 2)
+    {
+        counts.push_back(count);
+    }
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+//------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    Options options;
+
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    std::vector<Corpus> corpora(options.corpusPaths.size());
+    std::vector<const Sudoku*> allPuzzles;
+
+    for (std::size_t i = 0; i < corpora.size(); ++i)
+    {
+        if (!loadCorpus(options.corpusPaths[i], options.puzzleLimit, corpora[i]))
+        {
+            return 1;
+        }
+        for (const Sudoku& puzzle : corpora[i].puzzles)
+        {
+            allPuzzles.push_back(&puzzle);
+        }
+    }
+
+    // Opened on this thread, which runs every profiled solve
+    PerfCounters counters;
+    std::ofstream perPuzzle;
+
+    if (options.counters)
+    {
+        if (!counters.open())
+        {
+            std::cerr << "Hardware counters are unavailable (" << counters.problem() << "); reporting times only. \n";
+        }
+        else if (!counters.problem().empty())
+        {
+            std::cerr << "Some hardware counters are unavailable (" << counters.problem() << "). \n";
+        }
+
+        if (counters.isOpen() && !options.countersPath.empty())
+        {
+            perPuzzle.open(options.countersPath);
+
+            if (!perPuzzle.is_open())
+            {
+                std::cerr << "Error opening file '" << options.countersPath << "'. \n";
+                return 1;
+            }
+            perPuzzle << "solver,corpus,puzzle,phase";
+            for (const char* field : eventFields)
+            {
+                perPuzzle << ',' << field;
+            }
+            perPuzzle << ",ipc\n";
+        }
+    }
+
+    std::ostream& os = std::cout;
+
+    os << "{\n"
+       << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+
+    if (options.counters)
+    {
+        os << "  \"counters\": {\"available\": " << (counters.isOpen() ? "true" : "false")
+           << ", \"problem\": " << jsonString(counters.problem()) << "},\n";
+    }
+
+    os << "  \"backends\": [\n";
+
+    for (std::size_t b = 0; b < options.backends.size(); ++b)
+    {
+        const Backend& backend = options.backends[b];
+        std::cerr << "Benchmarking " << backend.name << "... \n";
+
+        // Build any per-thread solver state before anything is timed
+        if (!allPuzzles.empty())
+        {
+            Sudoku warmUp = *allPuzzles.front();
+            warmUp.setSolverStrategy(backend.strategy);
+            warmUp.solve();
+        }
+
+        os << "    {\"solver\": " << jsonString(backend.name) << ",\n"
+           << "      \"corpora\": [\n";
+
+        for (std::size_t c = 0; c < corpora.size(); ++c)
+        {
+            benchmarkCorpus(backend, corpora[c], &counters, perPuzzle.is_open() ? &perPuzzle : nullptr, os);
+            os << ((c + 1 < corpora.size()) ? ",\n" : "\n");
+        }
+
+        os << "      ],\n"
+           << "      \"throughput\": [\n";
+
+        const std::vector<int> counts = threadSweep(options.maxThreads);
+
+        for (std::size_t t = 0; t < counts.size(); ++t)
+        {
+            os << "        {\"threads\": " << counts[t]
+               << ", \"puzzles_per_second\": " << measureThroughput(backend, allPuzzles, counts[t]) << "}"
+               << ((t + 1 < counts.size()) ? ",\n" : "\n");
+        }
+
+        os << "      ]\n"
+           << "    }" << ((b + 1 < options.backends.size()) ? ",\n" : "\n");
+    }
+
+    const LaneSolver::Kernel kernel = LaneSolver::activeKernel();
+    std::cerr << "Benchmarking lanes... \n";
+
+    os << "  ],\n"
+       << "  \"lanes\": {\"kernel\": " << jsonString(LaneSolver::name(kernel))
+       << ", \"lane_count\": " << LaneSolver::laneCount(kernel) << ",\n"
+       << "    \"corpora\": [\n";
+
+    for (std::size_t c = 0; c < corpora.size(); ++c)
+    {
+        benchmarkLanes(corpora[c], os);
+        os << ((c + 1 < corpora.size()) ? ",\n" : "\n");
+    }
+
+    os << "    ]\n"
+       << "  }\n"
+       << "}\n";
+
+    return 0;
+}
@@ -0,0 +1,292 @@
+#include "cli_options.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+//------------------------------------------------------------------------------------------
+
+bool CliOptions::parse(int argc, char* argv[])
+{
+    threadCount = std::max(1u, std::thread::hardware_concurrency());
+    seed = static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = (i + 1 < argc);
+
+        if ((argument == "--batch") && hasValue)
+        {
+            mode = Mode::Batch;
+            inputPath = argv[++i];
+        }
+        else if ((argument == "--unique") && hasValue)
+        {
+            mode = Mode::FilterUnique;
+            inputPath = argv[++i];
+        }
+        else if ((argument == "--rate") && hasValue)
+        {
+            mode = Mode::Rate;
+            inputPath = argv[++i];
+        }
+        else if ((argument == "--pack") && hasValue)
+        {
+            mode = Mode::Pack;
+            inputPath = argv[++i];
+        }
+        else if ((argument == "--unpack") && hasValue)
+        {
+            mode = Mode::Unpack;
+            inputPath = argv[++i];
+        }
+        else if ((argument == "--serve") && hasValue)
+        {
+            mode = Mode::Serve;
+            socketPath = argv[++i];
+        }
+        else if ((argument == "--output") && hasValue)
+        {
+            outputPath = argv[++i];
+        }
+        else if ((argument == "--generate") && hasValue)
+        {
+            mode = Mode::Generate;
+
+            if (!parsePositive(argv[++i], generateCount))
+            {
+                std::cerr << "Puzzle count must be a positive integer. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--difficulty") && hasValue)
+        {
+            const auto difficultyIt = nameToDifficulty.find(argv[++i]);
+
+            if (difficultyIt == nameToDifficulty.end())
+            {
+                std::cerr << "Unknown difficulty '" << argv[i] << "'. \n";
+                return false;
+            }
+            difficulty = difficultyIt->second;
+        }
+        else if ((argument == "--seed") && hasValue)
+        {
+            if (!parseSeed(argv[++i], seed))
+            {
+                std::cerr << "Seed must be a non-negative integer. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--solver") && hasValue)
+        {
+            const auto strategyIt = nameToSolverStrategy.find(argv[++i]);
+
+            if (strategyIt == nameToSolverStrategy.end())
+            {
+                std::cerr << "Unknown solver '" << argv[i] << "'. \n";
+                return false;
+            }
+            solverStrategy = strategyIt->second;
+        }
+        else if ((argument == "--techniques") && hasValue)
+        {
+            if (!parseTechniques(argv[++i], techniques))
+            {
+                std::cerr << "Unknown techniques '" << argv[i] << "'. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--threads") && hasValue)
+        {
+            if (!parsePositive(argv[++i], threadCount))
+            {
+                std::cerr << "Thread count must be a positive integer. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--time-budget") && hasValue)
+        {
+            if (!parsePositive(argv[++i], timeBudgetMs))
+            {
+                std::cerr << "Time budget must be a positive number of milliseconds. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--node-budget") && hasValue)
+        {
+            if (!parsePositive(argv[++i], nodeBudget))
+            {
+                std::cerr << "Node budget must be a positive integer. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--cache") && hasValue)
+        {
+            if (!parsePositive(argv[++i], cacheCapacity))
+            {
+                std::cerr << "Cache size must be a positive number of puzzles. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--cache-file") && hasValue)
+        {
+            cachePath = argv[++i];
+        }
+        else if (argument == "--lanes")
+        {
+            laneSolving = true;
+        }
+        else if (argument == "--stats")
+        {
+            showStats = true;
+        }
+        else if (argument == "--solutions")
+        {
+            archiveSolutions = true;
+        }
+        else if (argument == "--index")
+        {
+            archiveIndex = true;
+        }
+        else if ((argument == "--find") && hasValue)
+        {
+            findPath = argv[++i];
+        }
+        else
+        {
+            std::cerr << "Unrecognised argument '" << argument << "'. \n";
+            return false;
+        }
+    }
+
+    if (!cachePath.empty() && (cacheCapacity == 0))
+    {
+        cacheCapacity = DefaultCacheCapacity;
+    }
+
+    if ((mode == Mode::Pack) && outputPath.empty())
+    {
+        std::cerr << "--pack needs an --output archive path. \n";
+        return false;
+    }
+    if ((mode != Mode::Unpack) && !findPath.empty())
+    {
+        std::cerr << "--find only applies to --unpack. \n";
+        return false;
+    }
+
+    // Nothing is solved to collect statistics from
+    if (showStats && ((mode == Mode::Generate) || (mode == Mode::Unpack) || ((mode == Mode::Pack) && !archiveSolutions)))
+    {
+        std::cerr << "--stats does not apply to --generate, --unpack or --pack without --solutions. \n";
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool CliOptions::parsePositive(const std::string& text, int& value)
+{
+    try
+    {
+        std::size_t parsedLength = 0;
+        value = std::stoi(text, &parsedLength);
+        return (parsedLength == text.size()) && (value > 0);
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+bool CliOptions::parseSeed(const std::string& text, std::uint64_t& value)
+{
+    try
+    {
+        std::size_t parsedLength = 0;
+        value = std::stoull(text, &parsedLength);
+        return (parsedLength == text.size()) && (text.front() != '-');
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+bool CliOptions::parseTechniques(const std::string& text, TechniqueMask& mask)
+{
+    if ((text == "all") || (text == "none"))
+    {
+        mask = (text == "all") ? AllTechniques : 0;
+        return true;
+    }
+
+    mask = 0;
+    std::size_t start = 0;
+
+    while (start <= text.size())
+    {
+        const std::size_t end = std::min(text.find(',', start), text.size());
+        const auto nameIt = std::find(techniqueNames.begin(), techniqueNames.end(), std::string_view(text).substr(start, end - start));
+
+        if (nameIt == techniqueNames.end())
+        {
+            return false;
+        }
+        mask |= techniqueBit(static_cast<Technique>(nameIt - techniqueNames.begin()));
+        start = end + 1;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+void CliOptions::printUsage(std::ostream& os)
+{
+    os << "Usage: ./main [--batch <file|-> | --unique <file|-> | --rate <file|-> | --generate N] [--threads N] \n"
+       << "              [--solver depth|propagation|dlx|iterative|deduction] [--techniques LIST] \n"
+       << "              [--difficulty easy|medium|hard|hardest] [--seed S] [--stats] \n"
+       << "              [--time-budget MS] [--node-budget N] [--cache N] [--cache-file FILE] [--lanes] \n"
+       << "       ./main --pack <file|-> --output ARCHIVE [--solutions] [--index] [--solver NAME] [--stats] \n"
+       << "       ./main --unpack ARCHIVE [--solutions] [--find <file|->] \n"
+       << "       ./main --serve SOCKET [--solver NAME] [--threads N] [--time-budget MS] [--node-budget N] [--stats] \n"
+       << "  With no arguments, starts the interactive game. \n"
+       << "  --batch   Solves one puzzle per line (81 characters, '.' or '0' for empty cells) \n"
+       << "            and writes one solved line per puzzle to stdout, in input order. \n"
+       << "  --unique  Writes only the puzzles that have exactly one solution, in input order. \n"
+       << "  --rate    Writes each puzzle followed by the dearest technique the deduction solver needed \n"
+       << "            for it, or 'guessing' if it had to guess. \n"
+       << "  --generate Writes N new puzzles with a unique solution, one per line. \n"
+       << "  --difficulty Difficulty of the generated puzzles (default: medium). \n"
+       << "  --seed    Seed of the generated puzzles; the same seed gives the same puzzles. \n"
+       << "  --solver  Solver used by the non-interactive modes (default: propagation). 'deduction' is \n"
+       << "            propagation that tries human-style techniques before guessing. \n"
+       << "  --techniques Techniques the deduction solver may use: 'all' (default), 'none', or a list of \n"
+       << "            pointing,claiming,naked-pair,hidden-pair,naked-triple,hidden-triple,x-wing,swordfish,xy-wing. \n"
+       << "  --threads Worker threads for the non-interactive modes (default: all cores). \n"
+       << "  --stats   Prints solver statistics (nodes, placements, backtracks, depth, time) after solving, \n"
+       << "            in the game and with --batch, --unique, --rate, --pack --solutions and --serve. \n"
+       << "  --time-budget, --node-budget \n"
+       << "            Per-puzzle limits of --batch; puzzles that go over them are finished by a \n"
+       << "            separate slow-lane thread so they do not hold up the others. \n"
+       << "  --cache   Keeps the solutions of up to N puzzles in --batch, so a repeat of a puzzle, or a \n"
+       << "            rotation, reflection, relabelling or band permutation of it, is not solved again. \n"
+       << "  --cache-file Loads the cache from FILE if it exists and saves it there at the end. \n"
+       << "  --lanes   Finishes the puzzles that naked and hidden singles can solve 8 to 32 at a time in \n"
+       << "            SIMD lanes in --batch, then solves the rest with --solver; the output is unchanged. \n"
+       << "  --pack    Converts CSV boards or puzzle lines to a binary archive of 41 bytes per puzzle; \n"
+       << "            --solutions also stores each solution and --index adds a lookup index. \n"
+       << "  --unpack  Writes the puzzles of an archive, or its solutions with --solutions, one per line; \n"
+       << "            --find writes only the records of the puzzles in a file, looked up by the index. \n"
+       << "  --serve   Solves puzzles sent to a Unix domain socket until interrupted; the budgets bound \n"
+       << "            each solve, and latency percentiles are printed on exit. \n";
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "sudoku.hpp"
+#include "sudoku_generator.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+//------------------------------------------------------------------------------------------
+
+// Command line options of ./main; with no arguments the interactive game is started
+struct CliOptions
+{
+    enum class Mode
+    {
+        Interactive,
+        Batch,
+        FilterUnique,
+        Generate,
+        // Rate each puzzle by the techniques it needs
+        Rate,
+        // Convert puzzles to or from the binary archive format
+        Pack,
+        Unpack,
+        // Solve puzzles sent over a Unix domain socket until stopped
+        Serve,
+    };
+
+    Mode mode = Mode::Interactive;
+
+    // Puzzle file for the non-interactive modes, "-" for stdin
+    std::string inputPath = "-";
+    // Archive written by --pack
+    std::string outputPath;
+    // Socket listened on by --serve
+    std::string socketPath;
+    Sudoku::SolverStrategy solverStrategy = Sudoku::SolverStrategy::Propagation;
+    // Techniques of the deduction solver
+    TechniqueMask techniques = AllTechniques;
+    // Worker threads for the non-interactive modes
+    int threadCount = 1;
+    // Print solver statistics after solving
+    bool showStats = false;
+    // Per-puzzle budgets of --batch before a puzzle moves to the slow lane, or of --serve
+    // before it gives up on a puzzle, 0 for none
+    int timeBudgetMs = 0;
+    int nodeBudget = 0;
+    // Solutions kept by the --batch solution cache, 0 for no cache, and the file it persists in
+    int cacheCapacity = 0;
+    std::string cachePath;
+    // Finish the puzzles that singles can solve in SIMD lanes before --batch solves the rest
+    bool laneSolving = false;
+
+    // Puzzles written by --generate
+    int generateCount = 0;
+    Difficulty difficulty = Difficulty::Medium;
+    std::uint64_t seed = 0;
+
+    // Puzzles whose records --unpack writes, looked up in the archive; empty for all records
+    std::string findPath;
+    // Archives made by --pack hold solutions and an index; --unpack writes the solutions
+    bool archiveSolutions = false;
+    bool archiveIndex = false;
+
+    // Returns true if every argument was understood
+    bool parse(int argc, char* argv[]);
+
+    static void printUsage(std::ostream&);
+
+    // Cache size when only --cache-file is given
+    static constexpr int DefaultCacheCapacity = 1 << 16;
+
+private:
+    // Returns true if text is a whole positive integer
+    static bool parsePositive(const std::string& text, int& value);
+    // Returns true if text is a whole non-negative integer
+    static bool parseSeed(const std::string& text, std::uint64_t& value);
+    // Returns true if text is "all", "none" or a comma-separated list of technique names
+    static bool parseTechniques(const std::string& text, TechniqueMask& mask);
+
+    static inline const std::unordered_map<std::string, Sudoku::SolverStrategy> nameToSolverStrategy =
+    {
+        {"depth",       Sudoku::SolverStrategy::DepthFirst},
+        {"propagation", Sudoku::SolverStrategy::Propagation},
+        {"dlx",         Sudoku::SolverStrategy::DancingLinks},
+        {"iterative",   Sudoku::SolverStrategy::Iterative},
+        {"deduction",   Sudoku::SolverStrategy::Deduction}
+    };
+
+    static inline const std::unordered_map<std::string, Difficulty> nameToDifficulty =
+    {
+        {"easy",    Difficulty::Easy},
+        {"medium",  Difficulty::Medium},
+        {"hard",    Difficulty::Hard},
+        {"hardest", Difficulty::WorldsHardest}
+    };
+};
@@ -0,0 +1,455 @@
+#include "deduction_pipeline.hpp"
+
+#include "solver_stats.hpp"
+
+//------------------------------------------------------------------------------------------
+
+namespace
+{
+    constexpr int Width = SudokuUnits::Width;
+    constexpr int BoxWidth = SudokuUnits::BoxWidth;
+    // First unit of each kind in unitCells
+    constexpr int ColumnUnits = Width;
+    constexpr int BoxUnits = 2 * Width;
+
+    // Positions of a line's cells that fall in one box (band k is BandPositions << 3k), and
+    // of a box's cells on one row (RowInBox << 3k) or column (ColumnInBox << k)
+    constexpr CandidateMask BandPositions = 0x007;
+    constexpr CandidateMask RowInBox = 0x007;
+    constexpr CandidateMask ColumnInBox = 0x049;
+
+    bool sees(int first, int second)
+    {
+        return (first != second)
+               && ((SudokuUnits::rowOf(first) == SudokuUnits::rowOf(second))
+                   || (SudokuUnits::colOf(first) == SudokuUnits::colOf(second))
+                   || (SudokuUnits::boxOf(first) == SudokuUnits::boxOf(second)));
+    }
+
+    // Calls visit with every choice of size (2 or 3) indices below count, in increasing order
+    template <typename Visit>
+    void forEachSubset(int count, int size, Visit&& visit)
+    {
+        std::array<int, 3> chosen{};
+
+        for (chosen[0] = 0; chosen[0] < count; ++chosen[0])
+        {
+            for (chosen[1] = chosen[0] + 1; chosen[1] < count; ++chosen[1])
+            {
+                if (size == 2)
+                {
+                    visit(chosen);
+                    continue;
+                }
+                for (chosen[2] = chosen[1] + 1; chosen[2] < count; ++chosen[2])
+                {
+                    visit(chosen);
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool DeductionPipeline::apply(Candidates& candidates, Stats& stats) const
+{
+    Places places;
+    findPlaces(candidates, places);
+
+    for (int index = 0; index < TechniqueCount; ++index)
+    {
+        const auto technique = static_cast<Technique>(index);
+
+        if ((enabled & techniqueBit(technique)) == 0)
+        {
+            continue;
+        }
+
+        const int fired = run(technique, candidates, places);
+
+        if (fired > 0)
+        {
+            stats.technique(technique, fired);
+            return true;
+        }
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::string_view DeductionPipeline::rating(const SolverStats& stats)
+{
+    if (stats.guesses > 0)
+    {
+        return "guessing";
+    }
+
+    for (int technique = TechniqueCount - 1; technique >= 0; --technique)
+    {
+        if (stats.techniques[technique] != 0)
+        {
+            return techniqueNames[technique];
+        }
+    }
+    return (stats.hiddenSingles > 0) ? "hidden-single" : "naked-single";
+}
+
+//------------------------------------------------------------------------------------------
+
+void DeductionPipeline::findPlaces(const Candidates& candidates, Places& places)
+{
+    for (auto& unit : places)
+    {
+        unit.fill(0);
+    }
+
+    for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+    {
+        const int row = SudokuUnits::rowOf(cell);
+        const int col = SudokuUnits::colOf(cell);
+        const int boxPosition = (row % BoxWidth) * BoxWidth + col % BoxWidth;
+        auto& rowPlaces = places[row];
+        auto& colPlaces = places[ColumnUnits + col];
+        auto& boxPlaces = places[BoxUnits + SudokuUnits::boxOf(cell)];
+
+        for (int digitIndex = 0; digitIndex < Width; ++digitIndex)
+        {
+            const unsigned present = (candidates[cell] >> digitIndex) & 1u;
+            rowPlaces[digitIndex] |= static_cast<CandidateMask>(present << col);
+            colPlaces[digitIndex] |= static_cast<CandidateMask>(present << row);
+            boxPlaces[digitIndex] |= static_cast<CandidateMask>(present << boxPosition);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+int DeductionPipeline::run(Technique technique, Candidates& candidates, const Places& places)
+{
+    switch (technique)
+    {
+        case Technique::Pointing:
+            return pointing(candidates, places);
+        case Technique::Claiming:
+            return claiming(candidates, places);
+        case Technique::NakedPair:
+            return nakedSubsets(candidates, 2);
+        case Technique::HiddenPair:
+            return hiddenSubsets(candidates, places, 2);
+        case Technique::NakedTriple:
+            return nakedSubsets(candidates, 3);
+        case Technique::HiddenTriple:
+            return hiddenSubsets(candidates, places, 3);
+        case Technique::XWing:
+            return fish(candidates, places, 2);
+        case Technique::Swordfish:
+            return fish(candidates, places, 3);
+        case Technique::XYWing:
+            return xyWing(candidates);
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------------------
+
+int DeductionPipeline::pointing(Candidates& candidates, const Places& places)
+{
+    int fired = 0;
+
+    for (int box = 0; box < Width; ++box)
+    {
+        const int firstRow = (box / BoxWidth) * BoxWidth;
+        const int firstCol = (box % BoxWidth) * BoxWidth;
+
+        for (int digitIndex = 0; digitIndex < Width; ++digitIndex)
+        {
+            const CandidateMask inBox = places[BoxUnits + box][digitIndex];
+
+            if (inBox == 0)
+            {
+                continue;
+            }
+
+            const auto digit = static_cast<CandidateMask>(1u << digitIndex);
+            bool eliminated = false;
+
+            for (int k = 0; k < BoxWidth; ++k)
+            {
+                // Confined to one row of the box: the rest of the row loses it
+                if ((inBox & ~(RowInBox << (BoxWidth * k))) == 0)
+                {
+                    const CandidateMask outside = places[firstRow + k][digitIndex] & ~(BandPositions << firstCol);
+                    eliminated |= eliminate(candidates, firstRow + k, outside, digit);
+                }
+                if ((inBox & ~(ColumnInBox << k)) == 0)
+                {
+                    const CandidateMask outside = places[ColumnUnits + firstCol + k][digitIndex] & ~(BandPositions << firstRow);
+                    eliminated |= eliminate(candidates, ColumnUnits + firstCol + k, outside, digit);
+                }
+            }
+            fired += eliminated ? 1 : 0;
+        }
+    }
+    return fired;
+}
+
+//------------------------------------------------------------------------------------------
+
+int DeductionPipeline::claiming(Candidates& candidates, const Places& places)
+{
+    int fired = 0;
+
+    for (int line = 0; line < BoxUnits; ++line)
+    {
+        const bool isRow = (line < ColumnUnits);
+        const int index = isRow ? line : line - ColumnUnits;
+
+        for (int digitIndex = 0; digitIndex < Width; ++digitIndex)
+        {
+            const CandidateMask onLine = places[line][digitIndex];
+
+            for (int k = 0; (k < BoxWidth) && (onLine != 0); ++k)
+            {
+                if ((onLine & ~(BandPositions << (BoxWidth * k))) != 0)
+                {
+                    continue;
+                }
+
+                // Confined to box k along the line: the rest of that box loses it
+                const int box = isRow ? (index / BoxWidth) * BoxWidth + k : k * BoxWidth + index / BoxWidth;
+                const CandidateMask lineInBox = isRow ? static_cast<CandidateMask>(RowInBox << (BoxWidth * (index % BoxWidth)))
+                                                      : static_cast<CandidateMask>(ColumnInBox << (index % BoxWidth));
+                const CandidateMask outside = places[BoxUnits + box][digitIndex] & ~lineInBox;
+
+                fired += eliminate(candidates, BoxUnits + box, outside, static_cast<CandidateMask>(1u << digitIndex)) ? 1 : 0;
+            }
+        }
+    }
+    return fired;
+}
+
+//------------------------------------------------------------------------------------------
+
+int DeductionPipeline::nakedSubsets(Candidates& candidates, int size)
+{
+    int fired = 0;
+
+    for (int unit = 0; unit < SudokuUnits::UnitCount; ++unit)
+    {
+        // Positions of the unsolved cells with no more candidates than the subset has digits
+        std::array<int, Width> open{};
+        int openCount = 0;
+
+        for (int position = 0; position < Width; ++position)
+        {
+            const int count = digitCounts[candidates[unitCells[unit][position]]];
+
+            if ((count >= 2) && (count <= size))
+            {
+                open[openCount++] = position;
+            }
+        }
+
+        forEachSubset(openCount, size, [&](const std::array<int, 3>& chosen)
+        {
+            CandidateMask digits = 0;
+            CandidateMask members = 0;
+
+            for (int i = 0; i < size; ++i)
+            {
+                digits |= candidates[unitCells[unit][open[chosen[i]]]];
+                members |= static_cast<CandidateMask>(1u << open[chosen[i]]);
+            }
+
+            if (digitCounts[digits] == size)
+            {
+                fired += eliminate(candidates, unit, static_cast<CandidateMask>(AllDigits & ~members), digits) ? 1 : 0;
+            }
+        });
+    }
+    return fired;
+}
+
+//------------------------------------------------------------------------------------------
+
+int DeductionPipeline::hiddenSubsets(Candidates& candidates, const Places& places, int size)
+{
+    int fired = 0;
+
+    for (int unit = 0; unit < SudokuUnits::UnitCount; ++unit)
+    {
+        // Digits with between two and size places in the unit
+        std::array<int, Width> open{};
+        int openCount = 0;
+
+        for (int digitIndex = 0; digitIndex < Width; ++digitIndex)
+        {
+            const int count = digitCounts[places[unit][digitIndex]];
+
+            if ((count >= 2) && (count <= size))
+            {
+                open[openCount++] = digitIndex;
+            }
+        }
+
+        forEachSubset(openCount, size, [&](const std::array<int, 3>& chosen)
+        {
+            CandidateMask digits = 0;
+            CandidateMask cells = 0;
+
+            for (int i = 0; i < size; ++i)
+            {
+                digits |= static_cast<CandidateMask>(1u << open[chosen[i]]);
+                cells |= places[unit][open[chosen[i]]];
+            }
+
+            if (digitCounts[cells] == size)
+            {
+                fired += eliminate(candidates, unit, cells, static_cast<CandidateMask>(AllDigits & ~digits)) ? 1 : 0;
+            }
+        });
+    }
+    return fired;
+}
+
+//------------------------------------------------------------------------------------------
+
+int DeductionPipeline::fish(Candidates& candidates, const Places& places, int size)
+{
+    int fired = 0;
+
+    // Rows as the base lines and columns as the cover, then the other way round
+    for (const int baseUnits : { 0, ColumnUnits })
+    {
+        for (int digitIndex = 0; digitIndex < Width; ++digitIndex)
+        {
+            const auto digit = static_cast<CandidateMask>(1u << digitIndex);
+            std::array<int, Width> open{};
+            int openCount = 0;
+
+            for (int line = 0; line < Width; ++line)
+            {
+                const int count = digitCounts[places[baseUnits + line][digitIndex]];
+
+                if ((count >= 2) && (count <= size))
+                {
+                    open[openCount++] = line;
+                }
+            }
+
+            forEachSubset(openCount, size, [&](const std::array<int, 3>& chosen)
+            {
+                CandidateMask cover = 0;
+                unsigned baseLines = 0;
+
+                for (int i = 0; i < size; ++i)
+                {
+                    cover |= places[baseUnits + open[chosen[i]]][digitIndex];
+                    baseLines |= 1u << open[chosen[i]];
+                }
+
+                if (digitCounts[cover] != size)
+                {
+                    return;
+                }
+
+                bool eliminated = false;
+
+                for (int line = 0; line < Width; ++line)
+                {
+                    if ((baseLines & (1u << line)) == 0)
+                    {
+                        eliminated |= eliminate(candidates, baseUnits + line, places[baseUnits + line][digitIndex] & cover, digit);
+                    }
+                }
+                fired += eliminated ? 1 : 0;
+            });
+        }
+    }
+    return fired;
+}
+
+//------------------------------------------------------------------------------------------
+
+int DeductionPipeline::xyWing(Candidates& candidates)
+{
+    int fired = 0;
+
+    for (int pivot = 0; pivot < SudokuUnits::CellCount; ++pivot)
+    {
+        const CandidateMask pivotDigits = candidates[pivot];
+
+        if (digitCounts[pivotDigits] != 2)
+        {
+            continue;
+        }
+
+        for (const int first : cellPeers[pivot])
+        {
+            // xz, sharing exactly x with the pivot xy
+            const CandidateMask firstDigits = candidates[first];
+
+            if ((digitCounts[firstDigits] != 2) || (digitCounts[firstDigits & pivotDigits] != 1))
+            {
+                continue;
+            }
+
+            const auto z = static_cast<CandidateMask>(firstDigits & ~pivotDigits);
+            const auto secondDigits = static_cast<CandidateMask>((pivotDigits & ~firstDigits) | z);
+
+            for (const int second : cellPeers[pivot])
+            {
+                if (candidates[second] != secondDigits)
+                {
+                    continue;
+                }
+
+                bool eliminated = false;
+
+                for (const int cell : cellPeers[first])
+                {
+                    eliminated |= sees(cell, second) && eliminate(candidates, cell, z);
+                }
+                fired += eliminated ? 1 : 0;
+            }
+        }
+    }
+    return fired;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool DeductionPipeline::eliminate(Candidates& candidates, int cell, CandidateMask digits)
+{
+    if ((candidates[cell] & digits) == 0)
+    {
+        return false;
+    }
+
+    candidates[cell] &= static_cast<CandidateMask>(~digits);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool DeductionPipeline::eliminate(Candidates& candidates, int unit, CandidateMask positions, CandidateMask digits)
+{
+    bool eliminated = false;
+
+    for (int position = 0; positions != 0; ++position, positions >>= 1)
+    {
+        if ((positions & 1u) != 0)
+        {
+            eliminated |= eliminate(candidates, unitCells[unit][position], digits);
+        }
+    }
+    return eliminated;
+}
+
+//------------------------------------------------------------------------------------------
+
+template bool DeductionPipeline::apply(Candidates&, SolverStats&) const;
+template bool DeductionPipeline::apply(Candidates&, NoSolverStats&) const;
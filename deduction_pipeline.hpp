@@ -0,0 +1,64 @@
+#pragma once
+
+#include "deduction_technique.hpp"
+#include "sudoku_units.hpp"
+
+#include <array>
+#include <string_view>
+
+struct SolverStats;
+
+//------------------------------------------------------------------------------------------
+
+// Human-style deductions on a 9x9 grid of candidates, for when naked and hidden singles
+// are stuck. apply tries the enabled techniques cheapest first and stops after the first
+// one that eliminates anything, so the caller can go back to singles before anything
+// dearer is tried. Every technique only removes candidates that no solution uses, so the
+// solutions of the grid never change; a grid with none may be left with an empty cell.
+//
+// Each instance of a technique that eliminated something is counted in the stats, and the
+// dearest technique a solve needed rates the puzzle.
+
+class DeductionPipeline
+{
+public:
+    using Candidates = std::array<CandidateMask, SudokuUnits::CellCount>;
+
+    void setTechniques(TechniqueMask mask) { enabled = mask; }
+    TechniqueMask techniques() const { return enabled; }
+
+    // Returns true if a technique eliminated a candidate. Stats is SolverStats, or
+    // NoSolverStats to collect nothing.
+    template <typename Stats>
+    bool apply(Candidates&, Stats&) const;
+
+    // Dearest step in the stats of one solve: "guessing", the dearest technique that
+    // fired, or "hidden-single" or "naked-single"
+    static std::string_view rating(const SolverStats&);
+
+private:
+    // For each unit and digit, the positions in the unit (as in unitCells) of the cells
+    // that have the digit. Built once per apply; later eliminations can only make it a
+    // superset of the truth, which every technique below tolerates.
+    using Places = std::array<std::array<CandidateMask, SudokuUnits::Width>, SudokuUnits::UnitCount>;
+
+    static void findPlaces(const Candidates&, Places&);
+
+    // Each returns the number of instances that eliminated a candidate
+    static int run(Technique, Candidates&, const Places&);
+    static int pointing(Candidates&, const Places&);
+    static int claiming(Candidates&, const Places&);
+    // Size 2 for pairs, 3 for triples
+    static int nakedSubsets(Candidates&, int size);
+    static int hiddenSubsets(Candidates&, const Places&, int size);
+    // Size 2 for X-wings, 3 for swordfish
+    static int fish(Candidates&, const Places&, int size);
+    static int xyWing(Candidates&);
+
+    // Remove digits from a cell, or from the cells of unit at positions, returning true if
+    // any were there
+    static bool eliminate(Candidates&, int cell, CandidateMask digits);
+    static bool eliminate(Candidates&, int unit, CandidateMask positions, CandidateMask digits);
+
+    TechniqueMask enabled = 0;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+//------------------------------------------------------------------------------------------
+
+// Eliminations beyond naked and hidden singles, from cheapest to dearest; the deduction
+// pipeline tries them in this order
+enum class Technique
+{
+    // A digit confined to one row or column within a box leaves the rest of that line
+    Pointing,
+    // A digit confined to one box within a row or column leaves the rest of that box
+    Claiming,
+    // Two cells of a unit with the same two candidates, or two digits with the same two
+    // cells, own those digits or cells; triples likewise with three
+    NakedPair,
+    HiddenPair,
+    NakedTriple,
+    HiddenTriple,
+    // A digit whose places in two (three) rows lie in the same two (three) columns leaves the
+    // rest of those columns, and the same with rows and columns swapped
+    XWing,
+    Swordfish,
+    // A two-candidate pivot and two two-candidate pincers it sees, xy, xz and yz: z leaves
+    // every cell that sees both pincers
+    XYWing,
+};
+
+constexpr int TechniqueCount = 9;
+
+// Bit t is set for each enabled technique t
+using TechniqueMask = std::uint16_t;
+
+constexpr TechniqueMask techniqueBit(Technique technique) { return static_cast<TechniqueMask>(1u << static_cast<int>(technique)); }
+
+inline constexpr TechniqueMask AllTechniques = (1u << TechniqueCount) - 1;
+
+// Names used on the command line and in statistics, in enum order
+inline constexpr std::array<std::string_view, TechniqueCount> techniqueNames =
+{
+    "pointing", "claiming", "naked-pair", "hidden-pair", "naked-triple", "hidden-triple", "x-wing", "swordfish", "xy-wing"
+};
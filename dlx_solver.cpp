@@ -0,0 +1,274 @@
+#include "dlx_solver.hpp"
+
+#include "sudoku.hpp"
+
+//------------------------------------------------------------------------------------------
+
+DlxSolver::DlxSolver()
+    : nodes(1 + ConstraintCount), columnSizes(1 + ConstraintCount), placementNodes(PlacementCount)
+{
+    nodes.reserve(1 + ConstraintCount + 4 * PlacementCount);
+
+    // Root and column headers form one circular list
+    for (int i = 0; i <= ConstraintCount; ++i)
+    {
+        nodes[i] = Node{ i - 1, i + 1, i, i, i, -1 };
+    }
+    nodes[Root].left = ConstraintCount;
+    nodes[ConstraintCount].right = Root;
+
+    for (int placement = 0; placement < PlacementCount; ++placement)
+    {
+        linkPlacement(placement);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool DlxSolver::solve(Sudoku& sudoku, Stats& stats)
+{
+    chosenCount = 0;
+    bool solved = true;
+
+    for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+    {
+        const int value = sudoku.values[cell];
+
+        if ((value != Sudoku::NoValue) && !selectGiven(cell * SudokuUnits::Width + value - 1))
+        {
+            solved = false;
+            break;
+        }
+    }
+    givenCount = chosenCount;
+
+    if (solved)
+    {
+        solved = search(stats);
+    }
+
+    if (solved)
+    {
+        for (int i = givenCount; i < chosenCount; ++i)
+        {
+            const int placement = nodes[chosen[i]].row;
+            const int cell = placement / SudokuUnits::Width;
+
+            sudoku.setNumber(SudokuUnits::rowOf(cell), SudokuUnits::colOf(cell), placement % SudokuUnits::Width + 1);
+        }
+    }
+
+    // Put the givens back so the matrix is whole again for the next puzzle
+    while (givenCount > 0)
+    {
+        uncoverRow(chosen[--givenCount]);
+    }
+    chosenCount = 0;
+
+    return solved;
+}
+
+//------------------------------------------------------------------------------------------
+
+void DlxSolver::linkPlacement(int placement)
+{
+    const int cell = placement / SudokuUnits::Width;
+    const int digit = placement % SudokuUnits::Width;
+
+    const std::array<int, 4> constraints =
+    {
+        cell,
+        SudokuUnits::CellCount + SudokuUnits::rowOf(cell) * SudokuUnits::Width + digit,
+        2 * SudokuUnits::CellCount + SudokuUnits::colOf(cell) * SudokuUnits::Width + digit,
+        3 * SudokuUnits::CellCount + SudokuUnits::boxOf(cell) * SudokuUnits::Width + digit,
+    };
+
+    const int first = static_cast<int>(nodes.size());
+    placementNodes[placement] = first;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const int column = header(constraints[i]);
+        const int node = first + i;
+        const int above = nodes[column].up;
+
+        nodes.push_back(Node{ first + (i + 3) % 4, first + (i + 1) % 4, above, column, column, placement });
+        nodes[above].down = node;
+        nodes[column].up = node;
+        ++columnSizes[column];
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void DlxSolver::cover(int column)
+{
+    nodes[nodes[column].right].left = nodes[column].left;
+    nodes[nodes[column].left].right = nodes[column].right;
+
+    for (int row = nodes[column].down; row != column; row = nodes[row].down)
+    {
+        for (int node = nodes[row].right; node != row; node = nodes[node].right)
+        {
+            nodes[nodes[node].down].up = nodes[node].up;
+            nodes[nodes[node].up].down = nodes[node].down;
+            --columnSizes[nodes[node].column];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void DlxSolver::uncover(int column)
+{
+    for (int row = nodes[column].up; row != column; row = nodes[row].up)
+    {
+        for (int node = nodes[row].left; node != row; node = nodes[node].left)
+        {
+            ++columnSizes[nodes[node].column];
+            nodes[nodes[node].down].up = node;
+            nodes[nodes[node].up].down = node;
+        }
+    }
+
+    nodes[nodes[column].right].left = column;
+    nodes[nodes[column].left].right = column;
+}
+
+//------------------------------------------------------------------------------------------
+
+void DlxSolver::coverRow(int node)
+{
+    cover(nodes[node].column);
+
+    for (int other = nodes[node].right; other != node; other = nodes[other].right)
+    {
+        cover(nodes[other].column);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void DlxSolver::uncoverRow(int node)
+{
+    for (int other = nodes[node].left; other != node; other = nodes[other].left)
+    {
+        uncover(nodes[other].column);
+    }
+
+    uncover(nodes[node].column);
+}
+
+//------------------------------------------------------------------------------------------
+
+bool DlxSolver::selectGiven(int placement)
+{
+    const int first = placementNodes[placement];
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const int column = nodes[first + i].column;
+
+        // A covered column is no longer linked into the header list
+        if (nodes[nodes[column].left].right != column)
+        {
+            return false;
+        }
+    }
+
+    coverRow(first);
+    chosen[chosenCount++] = first;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool DlxSolver::search(Stats& stats)
+{
+    // Every chosen row past the givens is one level down
+    stats.enterNode(chosenCount - givenCount);
+
+    if (stats.shouldStop())
+    {
+        return false;
+    }
+
+    if (nodes[Root].right == Root)
+    {
+        return true;
+    }
+
+    const int column = selectColumn();
+    const bool forced = (columnSizes[column] == 1);
+    bool solved = false;
+
+    cover(column);
+    stats.propagationStep();
+
+    for (int row = nodes[column].down; (row != column) && !solved && !stats.shouldStop(); row = nodes[row].down)
+    {
+        chosen[chosenCount++] = row;
+
+        for (int node = nodes[row].right; node != row; node = nodes[node].right)
+        {
+            cover(nodes[node].column);
+            stats.propagationStep();
+        }
+
+        stats.place();
+
+        if (!forced)
+        {
+            stats.guess();
+        }
+
+        solved = search(stats);
+
+        // Always unwind, so the matrix is whole again even after a solution is found
+        for (int node = nodes[row].left; node != row; node = nodes[node].left)
+        {
+            uncover(nodes[node].column);
+        }
+
+        if (!solved)
+        {
+            --chosenCount;
+
+            if (!forced)
+            {
+                stats.backtrack();
+            }
+        }
+    }
+
+    uncover(column);
+    return solved;
+}
+
+//------------------------------------------------------------------------------------------
+
+int DlxSolver::selectColumn() const
+{
+    int bestColumn = nodes[Root].right;
+
+    for (int column = bestColumn; column != Root; column = nodes[column].right)
+    {
+        if (columnSizes[column] < columnSizes[bestColumn])
+        {
+            bestColumn = column;
+
+            if (columnSizes[column] <= 1)
+            {
+                break;
+            }
+        }
+    }
+    return bestColumn;
+}
+
+//------------------------------------------------------------------------------------------
+
+template bool DlxSolver::solve(Sudoku&, SolverStats&);
+template bool DlxSolver::solve(Sudoku&, NoSolverStats&);
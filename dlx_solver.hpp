@@ -0,0 +1,73 @@
+#pragma once
+
+#include "solver_stats.hpp"
+#include "sudoku_units.hpp"
+
+#include <array>
+#include <vector>
+
+template <int BoxSize>
+class BasicSudoku;
+using Sudoku = BasicSudoku<3>;
+
+//------------------------------------------------------------------------------------------
+
+// Exact-cover solver using Knuth's Dancing Links (Algorithm X). The 729 candidate
+// placements are rows of a matrix whose 324 columns are the cell, row-digit, column-digit
+// and box-digit constraints. The node pool is built once per solver instance; every solve
+// unlinks nodes and links them back, so consecutive puzzles need no allocation.
+
+class DlxSolver
+{
+public:
+    DlxSolver();
+
+    // Returns true if successfully solved sudoku, writing the answers into it. Stats is
+    // SolverStats, or NoSolverStats to collect nothing.
+    template <typename Stats>
+    bool solve(Sudoku&, Stats&);
+
+private:
+    struct Node
+    {
+        int left;
+        int right;
+        int up;
+        int down;
+        int column;
+        int row;
+    };
+
+    static constexpr int ConstraintCount = 4 * SudokuUnits::CellCount;
+    static constexpr int PlacementCount = SudokuUnits::Width * SudokuUnits::CellCount;
+    static constexpr int Root = 0;
+
+    // Header of constraint column, offset past the root
+    static int header(int constraint) { return constraint + 1; }
+
+    void linkPlacement(int placement);
+
+    void cover(int column);
+    void uncover(int column);
+    void coverRow(int node);
+    void uncoverRow(int node);
+
+    // Covers the row of a given, returning false if it clashes with an earlier one
+    bool selectGiven(int placement);
+
+    template <typename Stats>
+    bool search(Stats&);
+
+    // Returns the uncovered column with the fewest rows
+    int selectColumn() const;
+
+    std::vector<Node> nodes;
+    std::vector<int> columnSizes;
+    // First node of each placement row
+    std::vector<int> placementNodes;
+
+    // Nodes of the rows chosen so far, givens first
+    std::array<int, SudokuUnits::CellCount> chosen;
+    int chosenCount = 0;
+    int givenCount = 0;
+};
@@ -0,0 +1,169 @@
+#include "iterative_solver.hpp"
+
+#include "sudoku.hpp"
+
+//------------------------------------------------------------------------------------------
+
+void IterativeSolver::load(const Sudoku& sudoku)
+{
+    values.fill(Sudoku::NoValue);
+    rowMasks.fill(0);
+    colMasks.fill(0);
+    boxMasks.fill(0);
+
+    emptyCount = 0;
+    depth = 0;
+    rootEntered = false;
+    status = Status::Yielded;
+
+    for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+    {
+        const int value = sudoku.values[cell];
+
+        if (value == Sudoku::NoValue)
+        {
+            trail[emptyCount++] = Frame{ static_cast<std::uint8_t>(cell), 0 };
+            continue;
+        }
+
+        // Two givens in one unit holding the same digit
+        if ((usedDigits(cell) & (1u << (value - 1))) != 0)
+        {
+            status = Status::Unsolvable;
+            return;
+        }
+        place(cell, value);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+IterativeSolver::Status IterativeSolver::run(std::uint64_t maxSteps, Stats& stats)
+{
+    if (status != Status::Yielded)
+    {
+        return status;
+    }
+
+    if (!rootEntered)
+    {
+        stats.enterNode(0);
+        rootEntered = true;
+    }
+
+    for (std::uint64_t step = 0; step < maxSteps; ++step)
+    {
+        // Out of budget: stop as if the step limit ran out, so the search can still be resumed
+        if (stats.shouldStop())
+        {
+            return status;
+        }
+
+        if (depth == emptyCount)
+        {
+            status = Status::Solved;
+            return status;
+        }
+
+        Frame& frame = trail[depth];
+
+        // Digits above the last one tried that are still free in the cell's units
+        const CandidateMask untried = AllDigits & ~((1u << frame.digit) - 1);
+        const CandidateMask options = untried & ~usedDigits(frame.cell);
+
+        if (options != 0)
+        {
+            frame.digit = static_cast<std::uint8_t>(lowestDigit(options));
+            place(frame.cell, frame.digit);
+            stats.guess();
+            stats.place();
+
+            if (++depth < emptyCount)
+            {
+                trail[depth].digit = 0;
+            }
+            stats.enterNode(depth);
+            continue;
+        }
+
+        frame.digit = 0;
+
+        if (depth == 0)
+        {
+            status = Status::Unsolvable;
+            return status;
+        }
+
+        // Pop back to the previous cell and take its digit out, ready for the next one
+        --depth;
+        unplace(trail[depth].cell, trail[depth].digit);
+        stats.backtrack();
+    }
+    return status;
+}
+
+//------------------------------------------------------------------------------------------
+
+void IterativeSolver::writeSolution(Sudoku& sudoku) const
+{
+    for (int i = 0; i < emptyCount; ++i)
+    {
+        const int cell = trail[i].cell;
+        sudoku.setNumber(SudokuUnits::rowOf(cell), SudokuUnits::colOf(cell), values[cell]);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool IterativeSolver::solve(Sudoku& sudoku, Stats& stats)
+{
+    load(sudoku);
+
+    if (run(Unlimited, stats) != Status::Solved)
+    {
+        return false;
+    }
+
+    writeSolution(sudoku);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+CandidateMask IterativeSolver::usedDigits(int cell) const
+{
+    return rowMasks[SudokuUnits::rowOf(cell)] | colMasks[SudokuUnits::colOf(cell)] | boxMasks[SudokuUnits::boxOf(cell)];
+}
+
+//------------------------------------------------------------------------------------------
+
+void IterativeSolver::place(int cell, int digit)
+{
+    const CandidateMask bit = static_cast<CandidateMask>(1u << (digit - 1));
+
+    values[cell] = static_cast<std::uint8_t>(digit);
+    rowMasks[SudokuUnits::rowOf(cell)] |= bit;
+    colMasks[SudokuUnits::colOf(cell)] |= bit;
+    boxMasks[SudokuUnits::boxOf(cell)] |= bit;
+}
+
+//------------------------------------------------------------------------------------------
+
+void IterativeSolver::unplace(int cell, int digit)
+{
+    const CandidateMask bit = static_cast<CandidateMask>(1u << (digit - 1));
+
+    values[cell] = Sudoku::NoValue;
+    rowMasks[SudokuUnits::rowOf(cell)] &= ~bit;
+    colMasks[SudokuUnits::colOf(cell)] &= ~bit;
+    boxMasks[SudokuUnits::boxOf(cell)] &= ~bit;
+}
+
+//------------------------------------------------------------------------------------------
+
+template IterativeSolver::Status IterativeSolver::run(std::uint64_t, SolverStats&);
+template IterativeSolver::Status IterativeSolver::run(std::uint64_t, NoSolverStats&);
+template bool IterativeSolver::solve(Sudoku&, SolverStats&);
+template bool IterativeSolver::solve(Sudoku&, NoSolverStats&);
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "solver_stats.hpp"
+#include "sudoku_units.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+template <int BoxSize>
+class BasicSudoku;
+using Sudoku = BasicSudoku<3>;
+
+//------------------------------------------------------------------------------------------
+
+// Depth-first search without recursion. The empty cells are listed once in row-major order,
+// and a fixed trail of at most 81 frames records the digit placed in each, so backtracking
+// pops a frame and clears its digit from the unit masks. The whole search lives in the
+// object rather than on the call stack, which lets a solve stop after a number of steps and
+// carry on later. It tries cells and digits in the same order as the recursive solver, so
+// both find the same solution with the same statistics.
+
+class IterativeSolver
+{
+public:
+    enum class Status
+    {
+        Solved,
+        Unsolvable,
+        // The step limit ran out; calling run again continues the search
+        Yielded,
+    };
+
+    static constexpr std::uint64_t Unlimited = std::numeric_limits<std::uint64_t>::max();
+
+    // Starts a new search on the givens of sudoku, dropping any search in progress
+    void load(const Sudoku&);
+
+    // Advances the search by at most maxSteps placements and undos. Stats is SolverStats,
+    // or NoSolverStats to collect nothing; pass the same one to every call of a solve.
+    template <typename Stats>
+    Status run(std::uint64_t maxSteps, Stats&);
+
+    // Writes the answers into sudoku, after run returned Solved
+    void writeSolution(Sudoku&) const;
+
+    // Returns true if successfully solved sudoku, writing the answers into it
+    template <typename Stats>
+    bool solve(Sudoku&, Stats&);
+
+private:
+    struct Frame
+    {
+        std::uint8_t cell;
+        // Digit placed in the cell, 0 before the first attempt
+        std::uint8_t digit;
+    };
+
+    CandidateMask usedDigits(int cell) const;
+    void place(int cell, int digit);
+    void unplace(int cell, int digit);
+
+    std::array<std::uint8_t, SudokuUnits::CellCount> values{};
+    std::array<CandidateMask, SudokuUnits::Width> rowMasks{};
+    std::array<CandidateMask, SudokuUnits::Width> colMasks{};
+    std::array<CandidateMask, SudokuUnits::Width> boxMasks{};
+
+    // One frame per empty cell, in search order
+    std::array<Frame, SudokuUnits::CellCount> trail{};
+    int emptyCount = 0;
+    // Frame being worked on; every frame below it holds a placed digit
+    int depth = 0;
+
+    Status status = Status::Unsolvable;
+    bool rootEntered = false;
+};
@@ -0,0 +1,464 @@
+#include "lane_solver.hpp"
+
+#include "sudoku.hpp"
+#include "sudoku_units.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define LANE_SOLVER_X86 1
+#endif
+
+// The kernel template is inlined into each target-specific entry point, so it is compiled
+// once per instruction set
+#if defined(__GNUC__) || defined(__clang__)
+    #define LANE_INLINE inline __attribute__((always_inline))
+    // Nothing taking or returning a vector is ever called, so its ABI does not matter
+    #pragma GCC diagnostic ignored "-Wpsabi"
+#else
+    #define LANE_INLINE inline
+#endif
+
+//------------------------------------------------------------------------------------------
+
+namespace
+{
+    // Lanes held in a plain array, with the operators the compiler's vector types have
+    template <int Count>
+    struct ScalarLanes
+    {
+        std::array<std::uint16_t, Count> lanes;
+
+        std::uint16_t& operator[](int lane) { return lanes[lane]; }
+        std::uint16_t operator[](int lane) const { return lanes[lane]; }
+
+        template <typename Operation>
+        static LANE_INLINE ScalarLanes combine(const ScalarLanes& a, const ScalarLanes& b, Operation operation)
+        {
+            ScalarLanes result;
+            for (int lane = 0; lane < Count; ++lane)
+            {
+                result.lanes[lane] = static_cast<std::uint16_t>(operation(a.lanes[lane], b.lanes[lane]));
+            }
+            return result;
+        }
+
+        friend LANE_INLINE ScalarLanes operator&(const ScalarLanes& a, const ScalarLanes& b) { return combine(a, b, [](unsigned x, unsigned y) { return x & y; }); }
+        friend LANE_INLINE ScalarLanes operator|(const ScalarLanes& a, const ScalarLanes& b) { return combine(a, b, [](unsigned x, unsigned y) { return x | y; }); }
+        friend LANE_INLINE ScalarLanes operator-(const ScalarLanes& a, const ScalarLanes& b) { return combine(a, b, [](unsigned x, unsigned y) { return x - y; }); }
+        friend LANE_INLINE ScalarLanes operator~(const ScalarLanes& a) { return combine(a, a, [](unsigned x, unsigned) { return ~x; }); }
+
+        ScalarLanes& operator&=(const ScalarLanes& other) { return *this = *this & other; }
+        ScalarLanes& operator|=(const ScalarLanes& other) { return *this = *this | other; }
+    };
+
+    using Lanes8 = ScalarLanes<8>;
+
+    // Lane count, and the operations that differ between the array and vector types
+    template <typename Lanes>
+    struct LaneOps;
+
+    template <>
+    struct LaneOps<Lanes8>
+    {
+        static constexpr int Count = 8;
+
+        static LANE_INLINE Lanes8 splat(std::uint16_t value)
+        {
+            Lanes8 result;
+            result.lanes.fill(value);
+            return result;
+        }
+
+        // All ones in the lanes that are zero, zero elsewhere
+        static LANE_INLINE Lanes8 isZero(const Lanes8& value)
+        {
+            Lanes8 result;
+            for (int lane = 0; lane < Count; ++lane)
+            {
+                result.lanes[lane] = (value.lanes[lane] == 0) ? 0xFFFF : 0;
+            }
+            return result;
+        }
+
+        static LANE_INLINE bool any(const Lanes8& value)
+        {
+            unsigned bits = 0;
+            for (int lane = 0; lane < Count; ++lane)
+            {
+                bits |= value.lanes[lane];
+            }
+            return bits != 0;
+        }
+    };
+
+#ifdef LANE_SOLVER_X86
+
+    // The compiler's generic vectors, lowered to AVX2 or AVX-512 by the entry point they are
+    // inlined into
+    typedef std::uint16_t Lanes16 __attribute__((vector_size(32)));
+    typedef std::uint16_t Lanes32 __attribute__((vector_size(64)));
+
+    template <typename Lanes>
+    struct VectorLaneOps
+    {
+        static constexpr int Count = sizeof(Lanes) / sizeof(std::uint16_t);
+
+        static LANE_INLINE Lanes splat(std::uint16_t value) { return Lanes{} + value; }
+        static LANE_INLINE Lanes isZero(const Lanes& value) { return (Lanes)(value == 0); }
+
+        static LANE_INLINE bool any(const Lanes& value)
+        {
+            std::uint64_t words[sizeof(Lanes) / sizeof(std::uint64_t)];
+            std::memcpy(words, &value, sizeof(words));
+
+            std::uint64_t bits = 0;
+            for (const std::uint64_t word : words)
+            {
+                bits |= word;
+            }
+            return bits != 0;
+        }
+    };
+
+    template <>
+    struct LaneOps<Lanes16> : VectorLaneOps<Lanes16> {};
+    template <>
+    struct LaneOps<Lanes32> : VectorLaneOps<Lanes32> {};
+
+#endif
+
+    //--------------------------------------------------------------------------------------
+
+    template <typename Lanes>
+    struct LaneGroup
+    {
+        static constexpr int Count = LaneOps<Lanes>::Count;
+
+        // Digits still possible in each cell, and the digit placed there (0 if none), as bit
+        // (digit - 1) in the lane of each board
+        std::array<Lanes, SudokuUnits::CellCount> candidates;
+        std::array<Lanes, SudokuUnits::CellCount> placed;
+
+        // Board in each lane, null for a free lane
+        std::array<Sudoku*, Count> boards;
+    };
+
+    // Lanes that ended a round contradictory, finished, or having placed something
+    template <typename Lanes>
+    struct RoundResult
+    {
+        Lanes dead;
+        Lanes full;
+        Lanes progress;
+    };
+
+    // One round for every lane: eliminates the digits placed so far from their peers, then
+    // places every naked single, then every hidden single. Cells placed in a round are
+    // only eliminated from their peers in the next one; working from stale candidates can
+    // miss a single but never make a wrong one, and a lane that places nothing has run out
+    // of singles.
+    template <typename Lanes>
+    LANE_INLINE RoundResult<Lanes> runRound(LaneGroup<Lanes>& group)
+    {
+        using Ops = LaneOps<Lanes>;
+
+        const Lanes zero = Ops::splat(0);
+        const Lanes allDigits = Ops::splat(AllDigits);
+        RoundResult<Lanes> result{ zero, Ops::splat(0xFFFF), zero };
+
+        std::array<Lanes, SudokuUnits::UnitCount> used;
+        Lanes duplicates = zero;
+
+        for (int unit = 0; unit < SudokuUnits::UnitCount; ++unit)
+        {
+            Lanes seen = zero;
+
+            for (const int cell : unitCells[unit])
+            {
+                const Lanes digit = group.placed[cell];
+                duplicates |= seen & digit;
+                seen |= digit;
+
+                if (unit < SudokuUnits::Width)
+                {
+                    result.full &= ~Ops::isZero(digit);
+                }
+            }
+            used[unit] = seen;
+        }
+        result.dead = ~Ops::isZero(duplicates);
+
+        for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+        {
+            const auto& units = cellUnits[cell];
+            const Lanes digit = group.placed[cell];
+            const Lanes remaining = (group.candidates[cell] & ~(used[units[0]] | used[units[1]] | used[units[2]])) | digit;
+
+            result.dead |= Ops::isZero(remaining);
+
+            const Lanes single = remaining & Ops::isZero(remaining & (remaining - Ops::splat(1))) & Ops::isZero(digit);
+            group.candidates[cell] = remaining;
+            group.placed[cell] = digit | single;
+            result.progress |= single;
+        }
+
+        for (const auto& unit : unitCells)
+        {
+            Lanes once = zero;
+            Lanes twice = zero;
+            Lanes fixed = zero;
+
+            for (const int cell : unit)
+            {
+                const Lanes open = group.candidates[cell] & Ops::isZero(group.placed[cell]);
+                twice |= once & open;
+                once |= open;
+                fixed |= group.placed[cell];
+            }
+
+            // A digit with no place left in the unit
+            result.dead |= ~Ops::isZero(allDigits & ~(once | fixed));
+
+            const Lanes hidden = once & ~twice & ~fixed;
+
+            if (!Ops::any(hidden))
+            {
+                continue;
+            }
+
+            for (const int cell : unit)
+            {
+                const Lanes hit = group.candidates[cell] & hidden & Ops::isZero(group.placed[cell]);
+
+                // The only place for two digits at once
+                result.dead |= ~Ops::isZero(hit & (hit - Ops::splat(1)));
+
+                group.placed[cell] |= hit;
+                group.candidates[cell] = (group.candidates[cell] & Ops::isZero(hit)) | hit;
+                result.progress |= hit;
+            }
+        }
+        return result;
+    }
+
+    //--------------------------------------------------------------------------------------
+
+    template <typename Lanes>
+    LANE_INLINE void loadLane(LaneGroup<Lanes>& group, int lane, Sudoku& board)
+    {
+        const std::uint8_t* values = board.cells();
+
+        for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+        {
+            // Bit (value - 1), or no bit for an empty cell
+            const auto digit = static_cast<std::uint16_t>((1u << values[cell]) >> 1);
+            group.placed[cell][lane] = digit;
+            group.candidates[cell][lane] = (digit == 0) ? AllDigits : digit;
+        }
+        group.boards[lane] = &board;
+    }
+
+    template <typename Lanes>
+    LANE_INLINE void storeLane(const LaneGroup<Lanes>& group, int lane, Sudoku& board)
+    {
+        std::uint8_t values[SudokuUnits::CellCount];
+
+        // A placed digit is a single bit, so the bits below it count one less than the digit
+        for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+        {
+            values[cell] = static_cast<std::uint8_t>(digitCounts[group.placed[cell][lane] - 1] + 1);
+        }
+        board.fillAnswers(values);
+    }
+
+    template <typename Lanes>
+    LANE_INLINE std::size_t propagateLanes(Sudoku* boards, std::size_t count)
+    {
+        constexpr int Count = LaneGroup<Lanes>::Count;
+
+        LaneGroup<Lanes> group;
+        group.candidates.fill(LaneOps<Lanes>::splat(0));
+        group.placed.fill(LaneOps<Lanes>::splat(0));
+        group.boards.fill(nullptr);
+
+        std::size_t next = 0;
+        std::size_t finished = 0;
+        int busy = 0;
+
+        for (int lane = 0; (lane < Count) && (next < count); ++lane, ++busy)
+        {
+            loadLane(group, lane, boards[next++]);
+        }
+
+        while (busy > 0)
+        {
+            const RoundResult<Lanes> round = runRound(group);
+
+            std::uint16_t dead[Count];
+            std::uint16_t full[Count];
+            std::uint16_t progress[Count];
+            std::memcpy(dead, &round.dead, sizeof(dead));
+            std::memcpy(full, &round.full, sizeof(full));
+            std::memcpy(progress, &round.progress, sizeof(progress));
+
+            for (int lane = 0; lane < Count; ++lane)
+            {
+                Sudoku* board = group.boards[lane];
+
+                // A lane carries on while it is consistent, unfinished and still placing
+                if (!board || (!dead[lane] && !full[lane] && progress[lane]))
+                {
+                    continue;
+                }
+
+                if (!dead[lane] && full[lane])
+                {
+                    storeLane(group, lane, *board);
+                    ++finished;
+                }
+
+                group.boards[lane] = nullptr;
+                --busy;
+
+                if (next < count)
+                {
+                    loadLane(group, lane, boards[next++]);
+                    ++busy;
+                }
+            }
+        }
+        return finished;
+    }
+
+    //--------------------------------------------------------------------------------------
+
+    std::size_t propagateScalar(Sudoku* boards, std::size_t count)
+    {
+        return propagateLanes<Lanes8>(boards, count);
+    }
+
+#ifdef LANE_SOLVER_X86
+
+    __attribute__((target("avx2")))
+    std::size_t propagateAvx2(Sudoku* boards, std::size_t count)
+    {
+        return propagateLanes<Lanes16>(boards, count);
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    std::size_t propagateAvx512(Sudoku* boards, std::size_t count)
+    {
+        return propagateLanes<Lanes32>(boards, count);
+    }
+
+#endif
+
+    bool isSupported(LaneSolver::Kernel kernel)
+    {
+        switch (kernel)
+        {
+            #ifdef LANE_SOLVER_X86
+                case LaneSolver::Kernel::Avx512:
+                    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+                case LaneSolver::Kernel::Avx2:
+                    return __builtin_cpu_supports("avx2");
+            #endif
+            default:
+                return kernel == LaneSolver::Kernel::Scalar;
+        }
+    }
+
+    LaneSolver::Kernel bestKernel()
+    {
+        for (const auto kernel : { LaneSolver::Kernel::Avx512, LaneSolver::Kernel::Avx2 })
+        {
+            if (isSupported(kernel))
+            {
+                return kernel;
+            }
+        }
+        return LaneSolver::Kernel::Scalar;
+    }
+
+    LaneSolver::Kernel selectedKernel = bestKernel();
+}
+
+//------------------------------------------------------------------------------------------
+
+std::size_t LaneSolver::propagate(Sudoku* boards, std::size_t count)
+{
+    switch (selectedKernel)
+    {
+        #ifdef LANE_SOLVER_X86
+            case Kernel::Avx512:
+                return propagateAvx512(boards, count);
+            case Kernel::Avx2:
+                return propagateAvx2(boards, count);
+        #endif
+        default:
+            return propagateScalar(boards, count);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+std::size_t LaneSolver::solve(Sudoku* boards, std::size_t count)
+{
+    std::size_t solved = propagate(boards, count);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        if (!boards[i].isDone() && boards[i].solve())
+        {
+            ++solved;
+        }
+    }
+    return solved;
+}
+
+//------------------------------------------------------------------------------------------
+
+LaneSolver::Kernel LaneSolver::activeKernel()
+{
+    return selectedKernel;
+}
+
+//------------------------------------------------------------------------------------------
+
+void LaneSolver::setKernel(Kernel kernel)
+{
+    selectedKernel = isSupported(kernel) ? kernel : Kernel::Scalar;
+}
+
+//------------------------------------------------------------------------------------------
+
+int LaneSolver::laneCount(Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::Avx512:
+            return 32;
+        case Kernel::Avx2:
+            return 16;
+        default:
+            return LaneOps<Lanes8>::Count;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+const char* LaneSolver::name(Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Kernel::Avx512:
+            return "avx512";
+        case Kernel::Avx2:
+            return "avx2";
+        default:
+            return "scalar";
+    }
+}
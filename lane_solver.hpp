@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+template <int BoxSize>
+class BasicSudoku;
+using Sudoku = BasicSudoku<3>;
+
+//------------------------------------------------------------------------------------------
+
+// Solves many 9x9 boards at once by naked and hidden singles, one board per SIMD lane. The
+// candidates of a cell for every board sit side by side in one vector, so each elimination
+// or test for a single is one instruction across all the lanes. The lanes advance together
+// a round at a time, and a lane whose board is finished, stuck, or shown to have no
+// solution is refilled with the next board straight away.
+//
+// Only forced placements are made, so a board the lanes finish has exactly one solution:
+// the one Sudoku::solve finds with any strategy. Boards the lanes cannot finish keep their
+// givens for a backtracking solver. On x86 the AVX-512 kernel (32 lanes) or AVX2 kernel
+// (16 lanes) is picked at runtime, with a scalar kernel of 8 lanes as the fallback; all
+// three give identical results.
+
+class LaneSolver
+{
+public:
+    enum class Kernel
+    {
+        Scalar,
+        Avx2,
+        Avx512,
+    };
+
+    // Finishes, in place, the boards that singles alone can solve, and returns how many. A
+    // finished board reports isDone(); the others are left untouched.
+    static std::size_t propagate(Sudoku* boards, std::size_t count);
+
+    // Solves every board as Sudoku::solve would, handing the ones the lanes cannot finish to
+    // the board's own solver strategy; returns how many were solved
+    static std::size_t solve(Sudoku* boards, std::size_t count);
+
+    // Kernel picked for this CPU
+    static Kernel activeKernel();
+
+    // Forces a kernel, falling back to scalar if the CPU lacks it; mainly for testing
+    static void setKernel(Kernel);
+
+    // Boards in flight at once with a kernel
+    static int laneCount(Kernel);
+    static const char* name(Kernel);
+};
@@ -0,0 +1,96 @@
+#include "latency_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+//------------------------------------------------------------------------------------------
+
+void LatencyHistogram::record(std::uint64_t micros)
+{
+    ++buckets[bucketOf(micros)];
+    ++total;
+    largest = std::max(largest, micros);
+}
+
+//------------------------------------------------------------------------------------------
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (int bucket = 0; bucket < BucketCount; ++bucket)
+    {
+        buckets[bucket] += other.buckets[bucket];
+    }
+    total += other.total;
+    largest = std::max(largest, other.largest);
+}
+
+//------------------------------------------------------------------------------------------
+
+void LatencyHistogram::clear()
+{
+    buckets.fill(0);
+    total = 0;
+    largest = 0;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    const double wanted = std::ceil(std::clamp(fraction, 0.0, 1.0) * static_cast<double>(total));
+    const std::uint64_t rank = std::max<std::uint64_t>(static_cast<std::uint64_t>(wanted), 1);
+    std::uint64_t seen = 0;
+
+    for (int bucket = 0; bucket < BucketCount; ++bucket)
+    {
+        seen += buckets[bucket];
+
+        if (seen >= rank)
+        {
+            return std::min(bucketLimit(bucket), largest);
+        }
+    }
+    return largest;
+}
+
+//------------------------------------------------------------------------------------------
+
+int LatencyHistogram::bucketOf(std::uint64_t micros)
+{
+    if (micros < ExactBuckets)
+    {
+        return static_cast<int>(micros);
+    }
+
+    int highBit = 4;
+    while ((micros >> (highBit + 1)) != 0)
+    {
+        ++highBit;
+    }
+
+    // The bits just below the highest one pick the bucket within its power of two
+    const int shift = highBit - SubBucketBits;
+    const int subBucket = static_cast<int>((micros >> shift) & ((1 << SubBucketBits) - 1));
+    return ExactBuckets + (highBit - 4) * (1 << SubBucketBits) + subBucket;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::uint64_t LatencyHistogram::bucketLimit(int bucket)
+{
+    if (bucket < ExactBuckets)
+    {
+        return static_cast<std::uint64_t>(bucket);
+    }
+
+    const int highBit = 4 + (bucket - ExactBuckets) / (1 << SubBucketBits);
+    const int subBucket = (bucket - ExactBuckets) % (1 << SubBucketBits);
+    const int shift = highBit - SubBucketBits;
+    const std::uint64_t lowest = static_cast<std::uint64_t>((1 << SubBucketBits) + subBucket) << shift;
+    return lowest + ((std::uint64_t{1} << shift) - 1);
+}
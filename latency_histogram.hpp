@@ -0,0 +1,36 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------
+
+// Latencies in microseconds, counted in log-linear buckets: one per microsecond below 16,
+// then eight per power of two, so a percentile read back is at most an eighth above the
+// true value. Recording is a few shifts and an increment, with no allocation.
+class LatencyHistogram
+{
+public:
+    void record(std::uint64_t micros);
+    void merge(const LatencyHistogram&);
+    void clear();
+
+    std::uint64_t count() const { return total; }
+    std::uint64_t max() const { return largest; }
+    // Smallest recorded latency bound that at least fraction of the samples are within,
+    // 0 when nothing has been recorded
+    std::uint64_t percentile(double fraction) const;
+
+private:
+    static constexpr int ExactBuckets = 16;
+    static constexpr int SubBucketBits = 3;
+    static constexpr int BucketCount = ExactBuckets + (64 - 4) * (1 << SubBucketBits);
+
+    static int bucketOf(std::uint64_t micros);
+    // Largest latency that falls in the bucket
+    static std::uint64_t bucketLimit(int bucket);
+
+    std::array<std::uint64_t, BucketCount> buckets{};
+    std::uint64_t total = 0;
+    std::uint64_t largest = 0;
+};
@@ -0,0 +1,505 @@
+// Drives a running solver server (./main --serve) with puzzles from a file over several
+// connections, each keeping a fixed number of requests in flight, and reports the sustained
+// rate of answers, the latency the clients saw and the server's own counters. Every solution
+// sent back is checked to keep the givens and to be a valid, full board.
+
+#include "latency_histogram.hpp"
+#include "mapped_file.hpp"
+#include "puzzle_scanner.hpp"
+#include "solver_protocol.hpp"
+#include "sudoku.hpp"
+#include "sudoku_validator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------------
+
+using Clock = std::chrono::steady_clock;
+using Cells = std::array<std::uint8_t, SolverProtocol::CellCount>;
+
+struct Options
+{
+    std::string socketPath;
+    std::string puzzlePath;
+    int connections = 4;
+    // Requests each connection keeps in flight
+    int depth = 16;
+    int seconds = 10;
+};
+
+// What one connection saw
+struct ConnectionResult
+{
+    LatencyHistogram latency;
+    std::array<std::uint64_t, SolverProtocol::StatusCount> statuses{};
+    // Solutions that changed a given or were not a valid, full board
+    std::uint64_t wrong = 0;
+    std::string error;
+};
+
+//------------------------------------------------------------------------------------------
+
+static void printUsage(std::ostream& os)
+{
+    os << "Usage: ./load_generator SOCKET PUZZLES [--connections N] [--depth N] [--seconds S] \n"
+       << "  SOCKET        Socket of a server started with ./main --serve SOCKET. \n"
+       << "  PUZZLES       Puzzle file in either format, sent round-robin. \n"
+       << "  --connections Client connections, each on its own thread (default: 4). \n"
+       << "  --depth       Requests each connection keeps in flight (default: 16). \n"
+       << "  --seconds     Time to keep sending for (default: 10). \n";
+}
+
+//------------------------------------------------------------------------------------------
+
+// Returns true if text is a whole positive integer
+static bool parsePositive(const std::string& text, int& value)
+{
+    try
+    {
+        std::size_t parsedLength = 0;
+        value = std::stoi(text, &parsedLength);
+        return (parsedLength == text.size()) && (value > 0);
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+static bool parseOptions(int argc, char* argv[], Options& options)
+{
+    std::vector<std::string> positional;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        const bool hasValue = (i + 1 < argc);
+
+        if ((argument == "--connections") && hasValue)
+        {
+            if (!parsePositive(argv[++i], options.connections))
+            {
+                std::cerr << "Connection count must be a positive integer. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--depth") && hasValue)
+        {
+            if (!parsePositive(argv[++i], options.depth))
+            {
+                std::cerr << "Depth must be a positive integer. \n";
+                return false;
+            }
+        }
+        else if ((argument == "--seconds") && hasValue)
+        {
+            if (!parsePositive(argv[++i], options.seconds))
+            {
+                std::cerr << "Duration must be a positive number of seconds. \n";
+                return false;
+            }
+        }
+        else if (argument.rfind("--", 0) == 0)
+        {
+            std::cerr << "Unrecognised argument '" << argument << "'. \n";
+            return false;
+        }
+        else
+        {
+            positional.push_back(argument);
+        }
+    }
+
+    if (positional.size() != 2)
+    {
+        return false;
+    }
+    options.socketPath = positional[0];
+    options.puzzlePath = positional[1];
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+static bool loadPuzzles(const std::string& path, std::vector<Cells>& puzzles)
+{
+    MappedFile file;
+
+    if (!file.open(path))
+    {
+        std::cerr << "Error opening file '" << path << "'. \n";
+        return false;
+    }
+
+    PuzzleScanner scanner(file.view(), PuzzleScanner::detectFormat(file.view()));
+    Sudoku sudoku;
+
+    for (auto result = scanner.next(sudoku); result != PuzzleScanner::Result::End; result = scanner.next(sudoku))
+    {
+        if (result == PuzzleScanner::Result::Error)
+        {
+            const ParseError& error = scanner.error();
+            std::cerr << "Error reading '" << path << "' at byte " << error.offset
+                      << " (line " << error.line << "): " << error.message << ". \n";
+            return false;
+        }
+
+        Cells& cells = puzzles.emplace_back();
+        std::copy_n(sudoku.cells(), cells.size(), cells.begin());
+    }
+
+    if (puzzles.empty())
+    {
+        std::cerr << "No puzzles in '" << path << "'. \n";
+        return false;
+    }
+    return true;
+}
+
+#ifdef __linux__
+
+//------------------------------------------------------------------------------------------
+
+// Returns the connected socket, or -1 with the reason in error
+static int connectTo(const std::string& path, std::string& error)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        error = "socket path too long";
+        return -1;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if ((fd < 0) || (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0))
+    {
+        error = std::string("cannot connect to '") + path + "': " + std::strerror(errno);
+
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+//------------------------------------------------------------------------------------------
+
+static bool sendAll(int fd, std::string& output)
+{
+    std::size_t sent = 0;
+
+    while (sent < output.size())
+    {
+        const ssize_t length = send(fd, output.data() + sent, output.size() - sent, MSG_NOSIGNAL);
+
+        if (length < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        sent += static_cast<std::size_t>(length);
+    }
+    output.clear();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+// Blocks until at least one more byte has arrived; returns false when the server has gone
+static bool receiveMore(int fd, std::string& input)
+{
+    char buffer[1 << 16];
+
+    while (true)
+    {
+        const ssize_t length = recv(fd, buffer, sizeof(buffer), 0);
+
+        if (length > 0)
+        {
+            input.append(buffer, static_cast<std::size_t>(length));
+            return true;
+        }
+        if ((length < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+// Keeps depth requests in flight until stopAt, then waits for the last answers. Request ids
+// are a round number times depth plus a slot, so the answer to each names the slot free to
+// send the next request from, and the puzzle the slot sent. The solutions that arrive
+// together are checked as one batch.
+static void runConnection(const Options& options, const std::vector<Cells>& puzzles, std::size_t firstPuzzle,
+                          Clock::time_point stopAt, ConnectionResult& result)
+{
+    const int fd = connectTo(options.socketPath, result.error);
+
+    if (fd < 0)
+    {
+        return;
+    }
+
+    const auto depth = static_cast<std::uint32_t>(options.depth);
+    std::vector<Clock::time_point> sentAt(depth);
+    std::vector<std::uint32_t> rounds(depth, 0);
+    std::vector<std::size_t> sentPuzzle(depth);
+    // Solutions of the answers read at once, back to back, and the check of each
+    std::vector<std::uint8_t> solutions;
+    std::vector<BoardCheck> checks;
+    std::size_t nextPuzzle = firstPuzzle % puzzles.size();
+    std::string output;
+    std::string input;
+    std::uint32_t inFlight = 0;
+
+    const auto queueRequest = [&](std::uint32_t slot)
+    {
+        const std::uint32_t id = rounds[slot]++ * depth + slot;
+        SolverProtocol::appendMessage(output, id, static_cast<std::uint8_t>(SolverProtocol::RequestType::Solve),
+                                      puzzles[nextPuzzle].data(), SolverProtocol::CellCount);
+        sentPuzzle[slot] = nextPuzzle;
+        nextPuzzle = (nextPuzzle + 1) % puzzles.size();
+        sentAt[slot] = Clock::now();
+        ++inFlight;
+    };
+
+    for (std::uint32_t slot = 0; slot < depth; ++slot)
+    {
+        queueRequest(slot);
+    }
+
+    while (inFlight > 0)
+    {
+        if (!sendAll(fd, output) || !receiveMore(fd, input))
+        {
+            result.error = "connection lost";
+            break;
+        }
+
+        const Clock::time_point now = Clock::now();
+        std::size_t offset = 0;
+        bool malformed = false;
+
+        while (const std::size_t length = SolverProtocol::messageLength(input, offset, malformed))
+        {
+            const auto* message = reinterpret_cast<const std::uint8_t*>(input.data() + offset + SolverProtocol::LengthBytes);
+            const std::uint32_t slot = SolverProtocol::loadU32(message) % depth;
+            const std::uint8_t status = message[4];
+            offset += length;
+
+            if ((status == static_cast<std::uint8_t>(SolverProtocol::Status::Ok))
+                && (length == SolverProtocol::LengthBytes + SolverProtocol::HeaderBytes + SolverProtocol::CellCount))
+            {
+                const std::uint8_t* solution = message + SolverProtocol::HeaderBytes;
+                const Cells& puzzle = puzzles[sentPuzzle[slot]];
+                const bool keepsGivens = std::equal(puzzle.begin(), puzzle.end(), solution,
+                                                    [](std::uint8_t given, std::uint8_t value) { return (given == 0) || (given == value); });
+
+                if (keepsGivens)
+                {
+                    solutions.insert(solutions.end(), solution, solution + SolverProtocol::CellCount);
+                }
+                else
+                {
+                    ++result.wrong;
+                }
+            }
+
+            result.latency.record(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now - sentAt[slot]).count()));
+            ++result.statuses[std::min<std::size_t>(status, SolverProtocol::StatusCount - 1)];
+            --inFlight;
+
+            if (now < stopAt)
+            {
+                queueRequest(slot);
+            }
+        }
+        input.erase(0, offset);
+
+        const std::size_t solved = solutions.size() / SolverProtocol::CellCount;
+        checks.resize(solved);
+        SudokuValidator::checkBatch(solutions.data(), solved, checks.data());
+        result.wrong += static_cast<std::uint64_t>(std::count_if(checks.begin(), checks.end(),
+                                                                 [](const BoardCheck& check) { return !check.done(); }));
+        solutions.clear();
+
+        if (malformed)
+        {
+            result.error = "malformed response";
+            break;
+        }
+    }
+
+    close(fd);
+}
+
+//------------------------------------------------------------------------------------------
+
+// Returns the server's counters, or an empty string if it did not answer
+static std::string fetchServerStats(const std::string& socketPath)
+{
+    std::string error;
+    const int fd = connectTo(socketPath, error);
+
+    if (fd < 0)
+    {
+        return {};
+    }
+
+    std::string output;
+    std::string input;
+    SolverProtocol::appendMessage(output, 0, static_cast<std::uint8_t>(SolverProtocol::RequestType::Stats), nullptr, 0);
+
+    std::string text;
+    bool malformed = false;
+
+    if (sendAll(fd, output))
+    {
+        while (receiveMore(fd, input))
+        {
+            if (const std::size_t length = SolverProtocol::messageLength(input, 0, malformed))
+            {
+                const std::size_t header = SolverProtocol::LengthBytes + SolverProtocol::HeaderBytes;
+                text = input.substr(header, length - header);
+                break;
+            }
+            if (malformed)
+            {
+                break;
+            }
+        }
+    }
+
+    close(fd);
+    return text;
+}
+
+//------------------------------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    Options options;
+
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(std::cerr);
+        return 2;
+    }
+
+    std::vector<Cells> puzzles;
+
+    if (!loadPuzzles(options.puzzlePath, puzzles))
+    {
+        return 1;
+    }
+
+    std::cerr << "Sending " << puzzles.size() << " puzzles over " << options.connections << " connections, "
+              << options.depth << " in flight on each, for " << options.seconds << " s... \n";
+
+    std::vector<ConnectionResult> results(options.connections);
+    std::vector<std::thread> threads;
+    const Clock::time_point start = Clock::now();
+    const Clock::time_point stopAt = start + std::chrono::seconds(options.seconds);
+
+    for (int i = 0; i < options.connections; ++i)
+    {
+        // Connections start at different puzzles so they do not send the same ones together
+        const std::size_t firstPuzzle = static_cast<std::size_t>(i) * puzzles.size() / options.connections;
+        threads.emplace_back(runConnection, std::cref(options), std::cref(puzzles), firstPuzzle, stopAt, std::ref(results[i]));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    LatencyHistogram latency;
+    std::array<std::uint64_t, SolverProtocol::StatusCount> statuses{};
+    std::uint64_t wrong = 0;
+    bool failed = false;
+
+    for (const ConnectionResult& result : results)
+    {
+        latency.merge(result.latency);
+
+        for (int status = 0; status < SolverProtocol::StatusCount; ++status)
+        {
+            statuses[status] += result.statuses[status];
+        }
+        wrong += result.wrong;
+
+        if (!result.error.empty())
+        {
+            std::cerr << "Connection error: " << result.error << ". \n";
+            failed = true;
+        }
+    }
+
+    std::cout << "Answers:        " << latency.count() << " (" << statuses[0] << " solved, " << statuses[1] << " unsolvable, "
+              << statuses[2] << " invalid, " << statuses[3] << " over budget, " << statuses[4] << " bad requests, " << statuses[5] << " internal errors) \n"
+              << "Throughput:     " << static_cast<double>(latency.count()) / elapsed.count() << " requests/s \n"
+              << "Client latency: p50 " << latency.percentile(0.50) << " us, p99 " << latency.percentile(0.99)
+              << " us, max " << latency.max() << " us \n";
+
+    if (wrong > 0)
+    {
+        std::cerr << wrong << " solutions sent back were wrong. \n";
+        failed = true;
+    }
+    if (statuses[static_cast<int>(SolverProtocol::Status::InternalError)] > 0)
+    {
+        std::cerr << "The server caught its solver giving back boards that are not solutions. \n";
+        failed = true;
+    }
+
+    const std::string serverStats = fetchServerStats(options.socketPath);
+
+    if (!serverStats.empty())
+    {
+        std::cout << "Server:         " << serverStats << "\n";
+    }
+
+    return failed ? 1 : 0;
+}
+
+#else
+
+//------------------------------------------------------------------------------------------
+
+int main(int, char*[])
+{
+    std::cerr << "The load generator needs Unix domain sockets, which are only supported on Linux here. \n";
+    return 1;
+}
+
+#endif
@@ -1,6 +1,73 @@
+#include "archive_converter.hpp"
+#include "cli_options.hpp"
+#include "solver_server.hpp"
+#include "sudoku_batch.hpp"
 #include "sudoku_cli_display.hpp"
 
-int main()
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+
+static const std::unordered_map<CliOptions::Mode, SudokuBatch::Task> modeToBatchTask =
+{
+    {CliOptions::Mode::Batch,        SudokuBatch::Task::Solve},
+    {CliOptions::Mode::FilterUnique, SudokuBatch::Task::FilterUnique},
+    {CliOptions::Mode::Generate,     SudokuBatch::Task::Generate},
+    {CliOptions::Mode::Rate,         SudokuBatch::Task::Rate}
+};
+
+int main(int argc, char* argv[])
 {
-    return SudokuCliDisplay{}.exec();
+    CliOptions options;
+
+    if (!options.parse(argc, argv))
+    {
+        CliOptions::printUsage(std::cerr);
+        return 2;
+    }
+
+    if ((options.mode == CliOptions::Mode::Pack) || (options.mode == CliOptions::Mode::Unpack))
+    {
+        ArchiveConverter converter;
+        converter.setSolverStrategy(options.solverStrategy);
+        converter.setSolutions(options.archiveSolutions);
+        converter.setWriteIndex(options.archiveIndex);
+        converter.setShowStats(options.showStats);
+        converter.setFindPath(options.findPath);
+
+        return (options.mode == CliOptions::Mode::Pack) ? converter.pack(options.inputPath, options.outputPath)
+                                                        : converter.unpack(options.inputPath);
+    }
+
+    if (options.mode == CliOptions::Mode::Serve)
+    {
+        SolverServer server;
+        server.setSocketPath(options.socketPath);
+        server.setSolverStrategy(options.solverStrategy);
+        server.setTechniques(options.techniques);
+        server.setThreadCount(options.threadCount);
+        server.setBudgets(std::chrono::milliseconds(options.timeBudgetMs), static_cast<std::uint64_t>(options.nodeBudget));
+        server.setShowStats(options.showStats);
+        return server.exec();
+    }
+
+    if (options.mode != CliOptions::Mode::Interactive)
+    {
+        SudokuBatch batch;
+        batch.setTask(modeToBatchTask.at(options.mode));
+        batch.setGeneratorOptions(options.generateCount, options.difficulty, options.seed);
+        batch.setInputPath(options.inputPath);
+        batch.setSolverStrategy(options.solverStrategy);
+        batch.setTechniques(options.techniques);
+        batch.setThreadCount(options.threadCount);
+        batch.setShowStats(options.showStats);
+        batch.setBudgets(std::chrono::milliseconds(options.timeBudgetMs), static_cast<std::uint64_t>(options.nodeBudget));
+        batch.setCache(static_cast<std::size_t>(options.cacheCapacity), options.cachePath);
+        batch.setLaneSolving(options.laneSolving);
+        return batch.exec();
+    }
+
+    SudokuCliDisplay display;
+    display.setShowStats(options.showStats);
+    return display.exec();
 }
@@ -0,0 +1,94 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------------
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+//------------------------------------------------------------------------------------------
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    #ifdef _WIN32
+        std::ifstream file{ path, std::ios::binary };
+
+        if (!file.is_open())
+        {
+            return false;
+        }
+
+        fallback.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        bytes = fallback.data();
+        length = fallback.size();
+        return true;
+    #else
+        const int descriptor = ::open(path.c_str(), O_RDONLY);
+
+        if (descriptor < 0)
+        {
+            return false;
+        }
+
+        struct stat status{};
+
+        if ((fstat(descriptor, &status) != 0) || !S_ISREG(status.st_mode))
+        {
+            ::close(descriptor);
+            return false;
+        }
+
+        length = static_cast<std::size_t>(status.st_size);
+
+        if (length > 0)
+        {
+            void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+            if (address == MAP_FAILED)
+            {
+                ::close(descriptor);
+                length = 0;
+                return false;
+            }
+
+            madvise(address, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const char*>(address);
+            mapped = true;
+        }
+
+        // The mapping stays valid after the descriptor is closed
+        ::close(descriptor);
+        return true;
+    #endif
+}
+
+//------------------------------------------------------------------------------------------
+
+void MappedFile::close()
+{
+    #ifndef _WIN32
+        if (mapped)
+        {
+            munmap(const_cast<char*>(bytes), length);
+        }
+    #endif
+
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+    fallback.clear();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+//------------------------------------------------------------------------------------------
+
+// Read-only memory mapping of a whole file. On platforms without mmap the file is read
+// into memory instead, behind the same interface.
+
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns true if the file was mapped; an empty file maps to an empty view
+    bool open(const std::string& path);
+    void close();
+
+    std::string_view view() const { return { bytes, length }; }
+
+private:
+    const char* bytes = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+
+    std::string fallback;
+};
@@ -0,0 +1,293 @@
+#include "perf_counters.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    #ifdef __linux__
+        struct EventConfig
+        {
+            std::uint32_t type;
+            std::uint64_t config;
+        };
+
+        constexpr std::uint64_t cacheReadMisses(std::uint64_t cache)
+        {
+            return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        }
+
+        // In Event order
+        const EventConfig eventConfigs[PerfCounters::EventCount] =
+        {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_HW_CACHE, cacheReadMisses(PERF_COUNT_HW_CACHE_L1D)},
+            {PERF_TYPE_HW_CACHE, cacheReadMisses(PERF_COUNT_HW_CACHE_LL)},
+        };
+
+        // Opens a disabled event on this thread, leading a new group if groupLeader is -1
+        int openEvent(const EventConfig& event, int groupLeader)
+        {
+            perf_event_attr attributes{};
+            attributes.size = sizeof(attributes);
+            attributes.type = event.type;
+            attributes.config = event.config;
+            attributes.disabled = (groupLeader < 0) ? 1 : 0;
+            attributes.exclude_kernel = 1;
+            attributes.exclude_hv = 1;
+            attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupLeader, PERF_FLAG_FD_CLOEXEC));
+        }
+
+        std::string describeError(int error)
+        {
+            switch (error)
+            {
+                case ENOENT:
+                case ENODEV:
+                case EOPNOTSUPP:
+                    return "no hardware counters are exposed here";
+                case EACCES:
+                case EPERM:
+                    return "not permitted; see /proc/sys/kernel/perf_event_paranoid";
+                case ENOSYS:
+                    return "perf_event_open is not available";
+                default:
+                    return std::strerror(error);
+            }
+        }
+    #endif
+}
+
+//------------------------------------------------------------------------------------------
+
+PerfCounters::Reading& PerfCounters::Reading::operator+=(const Reading& other)
+{
+    for (int i = 0; i < EventCount; ++i)
+    {
+        counts[i] += other.counts[i];
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------------------
+
+double PerfCounters::Reading::ipc() const
+{
+    const std::uint64_t cycles = (*this)[Event::Cycles];
+    return (cycles == 0) ? 0.0 : static_cast<double>((*this)[Event::Instructions]) / static_cast<double>(cycles);
+}
+
+//------------------------------------------------------------------------------------------
+
+double PerfCounters::Reading::perKiloInstruction(Event event) const
+{
+    const std::uint64_t instructions = (*this)[Event::Instructions];
+    return (instructions == 0) ? 0.0 : 1000.0 * static_cast<double>((*this)[event]) / static_cast<double>(instructions);
+}
+
+//------------------------------------------------------------------------------------------
+
+PerfCounters::~PerfCounters()
+{
+    close();
+}
+
+//------------------------------------------------------------------------------------------
+
+bool PerfCounters::open()
+{
+    close();
+
+    #ifdef __linux__
+        std::string missing;
+        int firstError = 0;
+
+        for (int e = 0; e < EventCount; ++e)
+        {
+            const int descriptor = openEvent(eventConfigs[e], leader);
+
+            if (descriptor < 0)
+            {
+                firstError = (firstError == 0) ? errno : firstError;
+                missing += missing.empty() ? "" : ", ";
+                missing += name(static_cast<Event>(e));
+                continue;
+            }
+            if (leader < 0)
+            {
+                leader = descriptor;
+            }
+            descriptors[opened] = descriptor;
+            slots[e] = opened++;
+        }
+
+        // Every event can open on its own and the group still not fit on the PMU, in which
+        // case it never runs; shed events from the end until it does
+        while ((opened > 0) && !probe())
+        {
+            missing += missing.empty() ? "" : ", ";
+            missing += name(static_cast<Event>(std::find(slots.begin(), slots.end(), opened - 1) - slots.begin()));
+            dropLast();
+        }
+
+        if (opened == 0)
+        {
+            why = (firstError != 0) ? describeError(firstError) : "the counters never got onto the PMU";
+            return false;
+        }
+        if (!missing.empty())
+        {
+            why = "left out " + missing;
+        }
+        return true;
+    #else
+        why = "hardware counters are only read on Linux";
+        return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------------------
+
+void PerfCounters::close()
+{
+    while (opened > 0)
+    {
+        dropLast();
+    }
+    why.clear();
+}
+
+//------------------------------------------------------------------------------------------
+
+void PerfCounters::dropLast()
+{
+    --opened;
+
+    #ifdef __linux__
+        ::close(descriptors[opened]);
+    #endif
+
+    for (int& slot : slots)
+    {
+        slot = (slot == opened) ? -1 : slot;
+    }
+    if (opened == 0)
+    {
+        leader = -1;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+bool PerfCounters::probe()
+{
+    start();
+
+    volatile std::uint64_t sum = 0;
+    for (std::uint64_t i = 0; i < 10000; ++i)
+    {
+        sum = sum + i;
+    }
+
+    #ifdef __linux__
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    #endif
+
+    Reading reading;
+    return read(reading);
+}
+
+//------------------------------------------------------------------------------------------
+
+void PerfCounters::start()
+{
+    #ifdef __linux__
+        if (leader >= 0)
+        {
+            ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    #endif
+}
+
+//------------------------------------------------------------------------------------------
+
+PerfCounters::Reading PerfCounters::stop()
+{
+    Reading reading;
+
+    #ifdef __linux__
+        if (leader >= 0)
+        {
+            ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            read(reading);
+        }
+    #endif
+
+    return reading;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool PerfCounters::read(Reading& reading) const
+{
+    #ifdef __linux__
+        // Event count, time enabled, time running, then a value per event in group order
+        std::uint64_t values[3 + EventCount] = {};
+
+        if ((leader < 0) || (::read(leader, values, sizeof(values)) < static_cast<ssize_t>(3 * sizeof(std::uint64_t))))
+        {
+            return false;
+        }
+
+        const std::uint64_t enabled = values[1];
+        const std::uint64_t running = values[2];
+
+        if (running == 0)
+        {
+            return false;
+        }
+
+        // Scale up for the time the group was multiplexed off the PMU
+        const double scale = static_cast<double>(enabled) / static_cast<double>(running);
+
+        for (int e = 0; e < EventCount; ++e)
+        {
+            if (slots[e] >= 0)
+            {
+                reading.counts[e] = static_cast<std::uint64_t>(static_cast<double>(values[3 + slots[e]]) * scale + 0.5);
+            }
+        }
+        return true;
+    #else
+        (void)reading;
+        return false;
+    #endif
+}
+
+//------------------------------------------------------------------------------------------
+
+const char* PerfCounters::name(Event event)
+{
+    switch (event)
+    {
+        case Event::Cycles:       return "cycles";
+        case Event::Instructions: return "instructions";
+        case Event::BranchMisses: return "branch-misses";
+        case Event::L1Misses:     return "l1-misses";
+        case Event::LlcMisses:    return "llc-misses";
+    }
+    return "";
+}
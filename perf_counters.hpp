@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+//------------------------------------------------------------------------------------------
+
+// Hardware performance counters of the calling thread, read with Linux perf_event_open
+// around a stretch of code. The counters run as one group, so they are all scheduled on
+// the PMU together and their ratios are exact; only user-space events are counted, so the
+// start and stop system calls stay out of the readings.
+//
+// Containers and virtual machines often expose no PMU at all, or too few counters for the
+// whole group. open then keeps whichever events work, or returns false with the reason,
+// and start and stop do nothing; other platforms always take that path.
+
+class PerfCounters
+{
+public:
+    enum class Event
+    {
+        Cycles,
+        Instructions,
+        BranchMisses,
+        // Level 1 data cache read misses
+        L1Misses,
+        // Last level cache read misses
+        LlcMisses,
+    };
+
+    static constexpr int EventCount = 5;
+
+    struct Reading
+    {
+        std::array<std::uint64_t, EventCount> counts{};
+
+        std::uint64_t operator[](Event event) const { return counts[static_cast<int>(event)]; }
+        Reading& operator+=(const Reading&);
+
+        // Instructions per cycle, 0 without cycles
+        double ipc() const;
+        // Events per thousand instructions, 0 without instructions
+        double perKiloInstruction(Event) const;
+    };
+
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // Returns true if at least one event can be counted on this thread
+    bool open();
+    void close();
+
+    bool isOpen() const { return leader >= 0; }
+    bool has(Event event) const { return slots[static_cast<int>(event)] >= 0; }
+    // Why open failed or which events it had to leave out, empty if it got them all
+    const std::string& problem() const { return why; }
+
+    void start();
+    // Counts since start; events that are not open read 0
+    Reading stop();
+
+    static const char* name(Event);
+
+private:
+    // Returns false if the group has not been on the PMU since start
+    bool read(Reading&) const;
+    // Returns true if the group as it stands gets onto the PMU
+    bool probe();
+    // Closes the last event of the group
+    void dropLast();
+
+    // Descriptor of each open event in group order, the first being the group leader
+    std::array<int, EventCount> descriptors{};
+    // Position of each event in the group's read, -1 if it is not open
+    std::array<int, EventCount> slots{ -1, -1, -1, -1, -1 };
+    int opened = 0;
+    int leader = -1;
+
+    std::string why;
+};
@@ -0,0 +1,310 @@
+#include "propagation_solver.hpp"
+
+#include "sudoku.hpp"
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool PropagationSolver::solve(Sudoku& sudoku, Stats& stats)
+{
+    if (countSolutions(sudoku, 1, stats) == 0)
+    {
+        return false;
+    }
+
+    for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+    {
+        if (!sudoku.fixedCells[cell])
+        {
+            sudoku.setNumber(SudokuUnits::rowOf(cell), SudokuUnits::colOf(cell), lowestDigit(solution.candidates[cell]));
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+int PropagationSolver::countSolutions(const Sudoku& sudoku, int limit, Stats& stats)
+{
+    State state;
+    solutionCount = 0;
+    solutionLimit = limit;
+    statsAtFirstSolution = SolverStats{};
+
+    if (load(sudoku, state, stats))
+    {
+        search(state, stats, 0);
+    }
+    return solutionCount;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool PropagationSolver::load(const Sudoku& sudoku, State& state, Stats& stats)
+{
+    state.candidates.fill(AllDigits);
+    state.placed.reset();
+    pendingCount = 0;
+
+    for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+    {
+        const int value = sudoku.values[cell];
+
+        if ((value != Sudoku::NoValue) && !assign(state, cell, static_cast<CandidateMask>(1u << (value - 1))))
+        {
+            return false;
+        }
+    }
+    return propagate(state, stats);
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool PropagationSolver::search(State& state, Stats& stats, int depth)
+{
+    stats.enterNode(depth);
+
+    // Unwind as if the solution limit were reached
+    if (stats.shouldStop())
+    {
+        return true;
+    }
+
+    const int cell = selectBranchCell(state);
+
+    if (cell < 0)
+    {
+        if (solutionCount++ == 0)
+        {
+            solution = state;
+
+            if constexpr (Stats::Enabled)
+            {
+                statsAtFirstSolution = stats;
+            }
+        }
+        return solutionCount >= solutionLimit;
+    }
+
+    CandidateMask remaining = state.candidates[cell];
+
+    while (remaining != 0)
+    {
+        const CandidateMask digit = lowestDigitBit(remaining);
+        remaining &= ~digit;
+
+        State next = state;
+        pendingCount = 0;
+        stats.guess();
+        stats.place();
+
+        if (assign(next, cell, digit) && propagate(next, stats) && search(next, stats, depth + 1))
+        {
+            return true;
+        }
+        stats.backtrack();
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool PropagationSolver::assign(State& state, int cell, CandidateMask digit)
+{
+    if ((state.candidates[cell] & digit) == 0)
+    {
+        return false;
+    }
+
+    state.candidates[cell] = digit;
+    state.placed.set(cell);
+    pending[pendingCount++] = static_cast<std::uint8_t>(cell);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool PropagationSolver::propagate(State& state, Stats& stats)
+{
+    bool placedAny = true;
+
+    while (placedAny)
+    {
+        if (!propagateNakedSingles(state, stats) || !propagateHiddenSingles(state, stats, placedAny))
+        {
+            return false;
+        }
+
+        // Singles are stuck: anything the pipeline eliminates may open up new ones
+        if (!placedAny && (pipeline.techniques() != 0) && !state.placed.all() && pipeline.apply(state.candidates, stats))
+        {
+            if (!placeNewSingles(state, stats))
+            {
+                return false;
+            }
+            placedAny = true;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool PropagationSolver::placeNewSingles(State& state, Stats& stats)
+{
+    for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+    {
+        const CandidateMask candidates = state.candidates[cell];
+
+        if (candidates == 0)
+        {
+            return false;
+        }
+        if (!state.placed[cell] && isSingleDigit(candidates))
+        {
+            state.placed.set(cell);
+            pending[pendingCount++] = static_cast<std::uint8_t>(cell);
+            stats.nakedSingle();
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool PropagationSolver::propagateNakedSingles(State& state, Stats& stats)
+{
+    while (pendingCount > 0)
+    {
+        const int cell = pending[--pendingCount];
+        const CandidateMask digit = state.candidates[cell];
+        stats.propagationStep();
+
+        for (const int peer : cellPeers[cell])
+        {
+            CandidateMask& peerCandidates = state.candidates[peer];
+
+            if ((peerCandidates & digit) == 0)
+            {
+                continue;
+            }
+
+            // Two placed cells in one unit holding the same digit
+            if (state.placed[peer])
+            {
+                return false;
+            }
+
+            peerCandidates &= ~digit;
+
+            if (peerCandidates == 0)
+            {
+                return false;
+            }
+            if (isSingleDigit(peerCandidates))
+            {
+                state.placed.set(peer);
+                pending[pendingCount++] = peer;
+                stats.nakedSingle();
+            }
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename Stats>
+bool PropagationSolver::propagateHiddenSingles(State& state, Stats& stats, bool& placedAny)
+{
+    placedAny = false;
+
+    for (const auto& unit : unitCells)
+    {
+        CandidateMask once = 0;
+        CandidateMask twice = 0;
+
+        for (const int cell : unit)
+        {
+            twice |= once & state.candidates[cell];
+            once |= state.candidates[cell];
+        }
+
+        // Some digit has nowhere left to go in this unit
+        if (once != AllDigits)
+        {
+            return false;
+        }
+
+        const CandidateMask hidden = once & ~twice;
+
+        if (hidden == 0)
+        {
+            continue;
+        }
+
+        for (const int cell : unit)
+        {
+            const CandidateMask own = state.candidates[cell] & hidden;
+
+            if ((own == 0) || state.placed[cell])
+            {
+                continue;
+            }
+
+            // The cell is the only home for two different digits
+            if (!isSingleDigit(own))
+            {
+                return false;
+            }
+
+            assign(state, cell, own);
+            placedAny = true;
+            stats.hiddenSingle();
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+int PropagationSolver::selectBranchCell(const State& state) const
+{
+    int bestCell = -1;
+    int bestCount = SudokuUnits::Width + 1;
+
+    for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+    {
+        if (state.placed[cell])
+        {
+            continue;
+        }
+
+        const int count = digitCounts[state.candidates[cell]];
+
+        if (count < bestCount)
+        {
+            bestCell = cell;
+            bestCount = count;
+
+            if (count == 2)
+            {
+                break;
+            }
+        }
+    }
+    return bestCell;
+}
+
+//------------------------------------------------------------------------------------------
+
+template bool PropagationSolver::solve(Sudoku&, SolverStats&);
+template bool PropagationSolver::solve(Sudoku&, NoSolverStats&);
+template int PropagationSolver::countSolutions(const Sudoku&, int, SolverStats&);
+template int PropagationSolver::countSolutions(const Sudoku&, int, NoSolverStats&);
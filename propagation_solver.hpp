@@ -0,0 +1,86 @@
+#pragma once
+
+#include "deduction_pipeline.hpp"
+#include "solver_stats.hpp"
+#include "sudoku_units.hpp"
+
+#include <array>
+#include <bitset>
+
+template <int BoxSize>
+class BasicSudoku;
+using Sudoku = BasicSudoku<3>;
+
+//------------------------------------------------------------------------------------------
+
+// Constraint-propagation solver: after every placement naked and hidden singles are
+// propagated to a fixpoint, and the search always branches on the cell with the fewest
+// candidates (minimum remaining values). With techniques enabled, a deduction pipeline
+// takes over whenever the singles are stuck, before any guess is made.
+
+class PropagationSolver
+{
+public:
+    // Returns true if successfully solved sudoku, writing the answers into it. Stats is
+    // SolverStats, or NoSolverStats to collect nothing.
+    template <typename Stats>
+    bool solve(Sudoku&, Stats&);
+
+    // Counts the solutions of the givens, stopping once limit are found. The search carries
+    // on from each solution rather than starting again, so a limit of 2 is a uniqueness check.
+    template <typename Stats>
+    int countSolutions(const Sudoku&, int limit, Stats&);
+
+    // Effort spent up to the first solution of the last search, which grades a puzzle
+    // without solving it a second time
+    const SolverStats& firstSolutionStats() const { return statsAtFirstSolution; }
+
+    // Deduction techniques tried when singles are stuck; none by default
+    void setTechniques(TechniqueMask mask) { pipeline.setTechniques(mask); }
+
+private:
+    struct State
+    {
+        std::array<CandidateMask, SudokuUnits::CellCount> candidates;
+        std::bitset<SudokuUnits::CellCount> placed;
+    };
+
+    // Loads the givens and propagates them, returning false if they contradict
+    template <typename Stats>
+    bool load(const Sudoku&, State&, Stats&);
+
+    // Returns true once solutionLimit solutions have been found
+    template <typename Stats>
+    bool search(State&, Stats&, int depth);
+
+    // Returns false if digit is no longer a candidate of cell
+    bool assign(State&, int cell, CandidateMask digit);
+    // Returns false if the board reached a contradiction
+    template <typename Stats>
+    bool propagate(State&, Stats&);
+    template <typename Stats>
+    bool propagateNakedSingles(State&, Stats&);
+    // Sets placedAny if a hidden single was found
+    template <typename Stats>
+    bool propagateHiddenSingles(State&, Stats&, bool& placedAny);
+
+    // Places the cells the pipeline left with one candidate, returning false if it left one
+    // with none
+    template <typename Stats>
+    bool placeNewSingles(State&, Stats&);
+
+    // Returns the unplaced cell with the fewest candidates, or -1 if every cell is placed
+    int selectBranchCell(const State&) const;
+
+    DeductionPipeline pipeline;
+
+    // First solution found
+    State solution;
+    SolverStats statsAtFirstSolution;
+    int solutionCount = 0;
+    int solutionLimit = 1;
+
+    // Placed cells whose digit has not yet been eliminated from their peers
+    std::array<std::uint8_t, SudokuUnits::CellCount> pending;
+    int pendingCount = 0;
+};
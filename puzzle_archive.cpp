@@ -0,0 +1,272 @@
+#include "puzzle_archive.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+
+//------------------------------------------------------------------------------------------
+
+template <typename T>
+static void storeLittle(std::uint8_t* bytes, T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        bytes[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+template <typename T>
+static T loadLittle(const std::uint8_t* bytes)
+{
+    T value = 0;
+
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        value |= static_cast<T>(static_cast<T>(bytes[i]) << (8 * i));
+    }
+    return value;
+}
+
+//------------------------------------------------------------------------------------------
+
+void ArchiveHeader::write(std::uint8_t* bytes) const
+{
+    std::fill_n(bytes, HeaderLength, 0);
+    std::memcpy(bytes, Magic, sizeof(Magic));
+    storeLittle(bytes + 4, version);
+    storeLittle(bytes + 6, flags);
+    storeLittle(bytes + 8, recordLength);
+    storeLittle(bytes + 12, boxSize);
+    storeLittle(bytes + 16, recordCount);
+    storeLittle(bytes + 24, indexOffset);
+}
+
+//------------------------------------------------------------------------------------------
+
+bool ArchiveHeader::read(const std::uint8_t* bytes)
+{
+    if (std::memcmp(bytes, Magic, sizeof(Magic)) != 0)
+    {
+        return false;
+    }
+
+    version = loadLittle<std::uint16_t>(bytes + 4);
+    flags = loadLittle<std::uint16_t>(bytes + 6);
+    recordLength = loadLittle<std::uint32_t>(bytes + 8);
+    boxSize = loadLittle<std::uint16_t>(bytes + 12);
+    recordCount = loadLittle<std::uint64_t>(bytes + 16);
+    indexOffset = loadLittle<std::uint64_t>(bytes + 24);
+    return version == CurrentVersion;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::uint32_t ArchiveHeader::recordLengthFor(std::uint16_t flags)
+{
+    const int blocks = (flags & HasSolutions) ? 2 : 1;
+    return static_cast<std::uint32_t>(blocks * Sudoku::PackedLength);
+}
+
+//------------------------------------------------------------------------------------------
+
+std::uint64_t archiveKey(const std::uint8_t* packedGivens)
+{
+    // FNV-1a
+    std::uint64_t hash = 14695981039346656037ull;
+
+    for (std::size_t i = 0; i < Sudoku::PackedLength; ++i)
+    {
+        hash = (hash ^ packedGivens[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool PuzzleArchiveWriter::open(const std::string& path, bool withSolutions, bool withIndex)
+{
+    file.open(path, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    header = ArchiveHeader{};
+    header.flags = static_cast<std::uint16_t>((withSolutions ? ArchiveHeader::HasSolutions : 0)
+                                              | (withIndex ? ArchiveHeader::HasIndex : 0));
+    header.recordLength = ArchiveHeader::recordLengthFor(header.flags);
+    indexEntries.clear();
+
+    // Room for the header, which is filled in by close
+    const std::array<char, ArchiveHeader::HeaderLength> placeholder{};
+    file.write(placeholder.data(), placeholder.size());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+void PuzzleArchiveWriter::add(const Sudoku& puzzle, const Sudoku* solution)
+{
+    std::array<std::uint8_t, 2 * Sudoku::PackedLength> record{};
+
+    // Only the givens go in the first block
+    Sudoku givens = puzzle;
+    givens.clearAnswers();
+    givens.storePacked(record.data());
+
+    if (header.flags & ArchiveHeader::HasSolutions)
+    {
+        (solution ? *solution : puzzle).storePacked(record.data() + Sudoku::PackedLength);
+    }
+
+    if (header.flags & ArchiveHeader::HasIndex)
+    {
+        indexEntries.emplace_back(archiveKey(record.data()), header.recordCount);
+    }
+
+    file.write(reinterpret_cast<const char*>(record.data()), header.recordLength);
+    ++header.recordCount;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool PuzzleArchiveWriter::close()
+{
+    if (header.flags & ArchiveHeader::HasIndex)
+    {
+        std::sort(indexEntries.begin(), indexEntries.end());
+        header.indexOffset = ArchiveHeader::HeaderLength + header.recordCount * header.recordLength;
+
+        for (const auto& [key, record] : indexEntries)
+        {
+            std::uint8_t entry[ArchiveHeader::IndexEntryLength];
+            storeLittle(entry, key);
+            storeLittle(entry + 8, record);
+            file.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+        }
+    }
+
+    std::uint8_t bytes[ArchiveHeader::HeaderLength];
+    header.write(bytes);
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    file.close();
+    return !file.fail();
+}
+
+//------------------------------------------------------------------------------------------
+
+bool PuzzleArchive::open(const std::string& path)
+{
+    if (!file.open(path))
+    {
+        std::cerr << "Error opening file '" << path << "'. \n";
+        return false;
+    }
+
+    const auto bytes = reinterpret_cast<const std::uint8_t*>(file.view().data());
+    const std::size_t length = file.view().size();
+
+    if ((length < ArchiveHeader::HeaderLength) || !header.read(bytes))
+    {
+        std::cerr << "Error reading '" << path << "'; not a puzzle archive of a known version. \n";
+        return false;
+    }
+
+    const std::uint64_t recordBytes = header.recordCount * header.recordLength;
+    const std::uint64_t indexBytes = hasIndex() ? header.recordCount * ArchiveHeader::IndexEntryLength : 0;
+
+    if ((header.boxSize != Sudoku::BoxWidth) || (header.recordLength != ArchiveHeader::recordLengthFor(header.flags))
+        || (header.recordCount > (length - ArchiveHeader::HeaderLength) / header.recordLength)
+        || (hasIndex() && ((header.indexOffset < ArchiveHeader::HeaderLength + recordBytes)
+                           || (header.indexOffset > length) || (length - header.indexOffset < indexBytes))))
+    {
+        std::cerr << "Error reading '" << path << "'; the archive is truncated or its header is corrupt. \n";
+        return false;
+    }
+
+    records = bytes + ArchiveHeader::HeaderLength;
+    index = hasIndex() ? bytes + header.indexOffset : nullptr;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+const std::uint8_t* PuzzleArchive::solution(std::size_t record) const
+{
+    return hasSolutions() ? givens(record) + Sudoku::PackedLength : nullptr;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool PuzzleArchive::load(std::size_t record, Sudoku& sudoku) const
+{
+    return sudoku.loadPacked(givens(record), solution(record));
+}
+
+//------------------------------------------------------------------------------------------
+
+std::optional<std::size_t> PuzzleArchive::find(const Sudoku& puzzle) const
+{
+    std::array<std::uint8_t, Sudoku::PackedLength> packed{};
+
+    Sudoku givensOnly = puzzle;
+    givensOnly.clearAnswers();
+    givensOnly.storePacked(packed.data());
+
+    const auto matches = [&](std::size_t record)
+    {
+        return std::memcmp(givens(record), packed.data(), packed.size()) == 0;
+    };
+
+    if (!index)
+    {
+        for (std::size_t record = 0; record < size(); ++record)
+        {
+            if (matches(record))
+            {
+                return record;
+            }
+        }
+        return std::nullopt;
+    }
+
+    const std::uint64_t key = archiveKey(packed.data());
+    const auto entryKey = [this](std::size_t entry)
+    {
+        return loadLittle<std::uint64_t>(index + entry * ArchiveHeader::IndexEntryLength);
+    };
+
+    // First entry with the key, then every entry sharing it in case of a collision
+    std::size_t low = 0;
+    std::size_t high = size();
+
+    while (low < high)
+    {
+        const std::size_t middle = low + (high - low) / 2;
+
+        if (entryKey(middle) < key)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    for (std::size_t entry = low; (entry < size()) && (entryKey(entry) == key); ++entry)
+    {
+        const auto record = loadLittle<std::uint64_t>(index + entry * ArchiveHeader::IndexEntryLength + 8);
+
+        if ((record < size()) && matches(static_cast<std::size_t>(record)))
+        {
+            return static_cast<std::size_t>(record);
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,236 @@
+#include "puzzle_scanner.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+//------------------------------------------------------------------------------------------
+
+namespace
+{
+    constexpr int Width = 9;
+
+    bool isDigit(char symbol) { return ('0' <= symbol) && (symbol <= '9'); }
+    bool isBlank(char symbol) { return (symbol == ' ') || (symbol == '\t'); }
+}
+
+//------------------------------------------------------------------------------------------
+
+PuzzleScanner::PuzzleScanner(std::string_view in, PuzzleFormat fmt, char delimiter,
+                             std::size_t offset, long long firstLine)
+    : input(in), format(fmt), delim(delimiter), baseOffset(offset), line(firstLine)
+{
+}
+
+//------------------------------------------------------------------------------------------
+
+PuzzleScanner::Result PuzzleScanner::next(Sudoku& sudoku)
+{
+    lastRecord = {};
+
+    if (!skipBlankLines())
+    {
+        return Result::End;
+    }
+
+    lastRecordOffset = baseOffset + position;
+    lastRecordLine = line;
+
+    return (format == PuzzleFormat::Line) ? scanLine(sudoku) : scanCsv(sudoku);
+}
+
+//------------------------------------------------------------------------------------------
+
+PuzzleFormat PuzzleScanner::detectFormat(std::string_view input, char delim)
+{
+    PuzzleScanner scanner(input, PuzzleFormat::Line, delim);
+
+    if (!scanner.skipBlankLines())
+    {
+        return PuzzleFormat::Line;
+    }
+
+    const std::string_view firstLine = input.substr(scanner.position, scanner.lineEnd(scanner.position) - scanner.position);
+    return (firstLine.find(delim) != std::string_view::npos) ? PuzzleFormat::Csv : PuzzleFormat::Line;
+}
+
+//------------------------------------------------------------------------------------------
+
+PuzzleScanner::Result PuzzleScanner::scanLine(Sudoku& sudoku)
+{
+    const std::size_t start = position;
+    const std::size_t end = contentEnd(start);
+    const std::size_t length = end - start;
+
+    lastRecord = input.substr(start, length);
+
+    for (std::size_t i = 0; i < std::min<std::size_t>(length, Sudoku::LineLength); ++i)
+    {
+        const char symbol = input[start + i];
+
+        if (isDigit(symbol))
+        {
+            cells[i] = static_cast<std::uint8_t>(symbol - '0');
+        }
+        else if (symbol == '.')
+        {
+            cells[i] = 0;
+        }
+        else
+        {
+            return fail(start + i, "unexpected character in puzzle line");
+        }
+    }
+
+    if (length < Sudoku::LineLength)
+    {
+        return fail(end, "puzzle line has fewer than 81 cells");
+    }
+    if (length > Sudoku::LineLength)
+    {
+        return fail(start + Sudoku::LineLength, "puzzle line has more than 81 cells");
+    }
+
+    advancePastLine();
+    sudoku.loadGivens(cells.data());
+    return Result::Puzzle;
+}
+
+//------------------------------------------------------------------------------------------
+
+PuzzleScanner::Result PuzzleScanner::scanCsv(Sudoku& sudoku)
+{
+    const std::size_t boardStart = position;
+
+    for (int row = 0; row < Width; ++row)
+    {
+        const int rowsLeft = Width - 1 - row;
+
+        if (position >= input.size())
+        {
+            return fail(position, "board ends before 9 rows");
+        }
+
+        const std::size_t end = contentEnd(position);
+        std::size_t cursor = position;
+        int column = 0;
+
+        while (true)
+        {
+            while ((cursor < end) && isBlank(input[cursor]))
+            {
+                ++cursor;
+            }
+
+            if ((cursor == end) || !isDigit(input[cursor]))
+            {
+                return fail(cursor, "expected a number", rowsLeft);
+            }
+
+            const std::size_t numberStart = cursor;
+            int value = 0;
+
+            while ((cursor < end) && isDigit(input[cursor]) && (value <= Width))
+            {
+                value = value * 10 + (input[cursor++] - '0');
+            }
+
+            if (value > Width)
+            {
+                return fail(numberStart, "number is out of range", rowsLeft);
+            }
+            if (column == Width)
+            {
+                return fail(numberStart, "more than 9 columns in row", rowsLeft);
+            }
+
+            cells[row * Width + column++] = static_cast<std::uint8_t>(value);
+
+            while ((cursor < end) && isBlank(input[cursor]))
+            {
+                ++cursor;
+            }
+
+            if (cursor == end)
+            {
+                break;
+            }
+            if (input[cursor] != delim)
+            {
+                return fail(cursor, "expected a delimiter", rowsLeft);
+            }
+            ++cursor;
+        }
+
+        if (column != Width)
+        {
+            return fail(end, "fewer than 9 columns in row", rowsLeft);
+        }
+
+        advancePastLine();
+    }
+
+    lastRecord = input.substr(boardStart, position - boardStart);
+    sudoku.loadGivens(cells.data());
+    return Result::Puzzle;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool PuzzleScanner::skipBlankLines()
+{
+    while (position < input.size())
+    {
+        const std::size_t end = contentEnd(position);
+
+        if (end != position)
+        {
+            return true;
+        }
+        advancePastLine();
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::size_t PuzzleScanner::lineEnd(std::size_t start) const
+{
+    const void* newline = std::memchr(input.data() + start, '\n', input.size() - start);
+    return newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - input.data()) : input.size();
+}
+
+//------------------------------------------------------------------------------------------
+
+std::size_t PuzzleScanner::contentEnd(std::size_t start) const
+{
+    const std::size_t end = lineEnd(start);
+    return ((end > start) && (input[end - 1] == '\r')) ? end - 1 : end;
+}
+
+//------------------------------------------------------------------------------------------
+
+void PuzzleScanner::advancePastLine()
+{
+    position = std::min(lineEnd(position) + 1, input.size());
+    ++line;
+}
+
+//------------------------------------------------------------------------------------------
+
+PuzzleScanner::Result PuzzleScanner::fail(std::size_t errorPosition, const char* message, int skippedLines)
+{
+    lastError = ParseError{ baseOffset + errorPosition, line, message };
+
+    if (lastRecord.empty())
+    {
+        lastRecord = input.substr(position, contentEnd(position) - position);
+    }
+
+    advancePastLine();
+
+    for (int i = 0; (i < skippedLines) && skipBlankLines(); ++i)
+    {
+        advancePastLine();
+    }
+    return Result::Error;
+}
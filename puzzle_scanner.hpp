@@ -0,0 +1,91 @@
+#pragma once
+
+#include "sudoku.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+//------------------------------------------------------------------------------------------
+
+enum class PuzzleFormat
+{
+    // One puzzle per line: 81 cells in row-major order, '.' or '0' for empty cells
+    Line,
+    // Nine rows of nine delimited numbers per puzzle, 0 for empty cells
+    Csv,
+};
+
+struct ParseError
+{
+    // Position of the offending byte, counted from the start of the whole input
+    std::size_t offset = 0;
+    long long line = 0;
+    const char* message = "";
+};
+
+//------------------------------------------------------------------------------------------
+
+// Parses puzzles straight out of a byte range, such as a MappedFile, with a hand-rolled
+// digit scanner; nothing is copied into intermediate strings. After an error the scanner
+// resumes at the next record, so one bad puzzle does not end a whole file.
+
+class PuzzleScanner
+{
+public:
+    enum class Result
+    {
+        Puzzle,
+        Error,
+        End,
+    };
+
+    // baseOffset and baseLine locate input within a larger file, so errors point into it
+    PuzzleScanner(std::string_view input, PuzzleFormat, char delim = ',',
+                  std::size_t baseOffset = 0, long long baseLine = 1);
+
+    // Loads the next puzzle into the sudoku as its givens
+    Result next(Sudoku&);
+
+    const ParseError& error() const { return lastError; }
+
+    // Raw bytes of the record read by the last call to next, without the line ending
+    std::string_view record() const { return lastRecord; }
+    // Where that record starts in the whole input
+    std::size_t recordOffset() const { return lastRecordOffset; }
+    long long recordLine() const { return lastRecordLine; }
+
+    // Guesses the format from the first non-blank line
+    static PuzzleFormat detectFormat(std::string_view input, char delim = ',');
+
+private:
+    Result scanLine(Sudoku&);
+    Result scanCsv(Sudoku&);
+
+    // Returns false if the input is exhausted
+    bool skipBlankLines();
+
+    // Index of the '\n' ending the line at position, or the input size
+    std::size_t lineEnd(std::size_t position) const;
+    // Index just past the line content, excluding any '\r'
+    std::size_t contentEnd(std::size_t position) const;
+    void advancePastLine();
+
+    // Records an error at position, then skips the current line and skippedLines more
+    Result fail(std::size_t position, const char* message, int skippedLines = 0);
+
+    std::string_view input;
+    PuzzleFormat format;
+    char delim;
+    std::size_t baseOffset;
+    long long line;
+    std::size_t position = 0;
+
+    std::array<std::uint8_t, Sudoku::LineLength> cells{};
+
+    ParseError lastError;
+    std::string_view lastRecord;
+    std::size_t lastRecordOffset = 0;
+    long long lastRecordLine = 0;
+};
@@ -0,0 +1,199 @@
+#include "solution_cache.hpp"
+
+#include "puzzle_archive.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+//------------------------------------------------------------------------------------------
+
+SolutionCache::SolutionCache(std::size_t capacity, int shardCount)
+{
+    capacity = std::max<std::size_t>(capacity, 1);
+    const std::size_t count = std::min(static_cast<std::size_t>(std::max(shardCount, 1)), capacity);
+
+    // The first shards take one more each when capacity does not divide evenly
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        shards.push_back(std::make_unique<Shard>());
+        shards.back()->capacity = capacity / count + ((i < capacity % count) ? 1 : 0);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SolutionCache::lookup(const CanonicalForm& form, Sudoku& sudoku)
+{
+    Cells solution;
+    Shard& shard = shardFor(form.cells);
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto found = shard.index.find(form.cells);
+
+        if (found == shard.index.end())
+        {
+            missCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+        solution = found->second->solution;
+    }
+    hitCount.fetch_add(1, std::memory_order_relaxed);
+
+    Cells answers;
+    form.transform.invert(solution.data(), answers.data());
+    sudoku.fillAnswers(answers.data());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolutionCache::insert(const CanonicalForm& form, const Sudoku& solved)
+{
+    Cells solution;
+    form.transform.apply(solved.cells(), solution.data());
+    insertCanonical(form.cells, solution);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolutionCache::insertCanonical(const Cells& puzzle, const Cells& solution)
+{
+    Shard& shard = shardFor(puzzle);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    const auto found = shard.index.find(puzzle);
+
+    if (found != shard.index.end())
+    {
+        found->second->solution = solution;
+        shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+        return;
+    }
+
+    shard.entries.push_front(Entry{ puzzle, solution });
+    shard.index.emplace(puzzle, shard.entries.begin());
+
+    if (shard.entries.size() > shard.capacity)
+    {
+        shard.index.erase(shard.entries.back().puzzle);
+        shard.entries.pop_back();
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+std::size_t SolutionCache::size() const
+{
+    std::size_t total = 0;
+
+    for (const auto& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->entries.size();
+    }
+    return total;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SolutionCache::load(const std::string& path)
+{
+    PuzzleArchive archive;
+
+    if (!archive.open(path))
+    {
+        return false;
+    }
+    if (!archive.hasSolutions())
+    {
+        std::cerr << "Error reading '" << path << "'; the archive holds no solutions. \n";
+        return false;
+    }
+
+    Sudoku puzzle;
+    Sudoku solved;
+
+    for (std::size_t record = 0; record < archive.size(); ++record)
+    {
+        if (!puzzle.loadPacked(archive.givens(record)) || !archive.load(record, solved))
+        {
+            std::cerr << "Error reading '" << path << "'; record " << record << " is corrupt. \n";
+            return false;
+        }
+        if (!puzzle.hasUniqueSolution())
+        {
+            continue;
+        }
+
+        Cells puzzleCells;
+        Cells solutionCells;
+        std::copy_n(puzzle.cells(), puzzleCells.size(), puzzleCells.begin());
+        std::copy_n(solved.cells(), solutionCells.size(), solutionCells.begin());
+        insertCanonical(puzzleCells, solutionCells);
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SolutionCache::save(const std::string& path) const
+{
+    PuzzleArchiveWriter writer;
+
+    if (!writer.open(path, true, false))
+    {
+        std::cerr << "Error creating file '" << path << "'. \n";
+        return false;
+    }
+
+    Sudoku puzzle;
+    Sudoku solved;
+
+    for (const auto& shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+
+        for (auto entry = shard->entries.rbegin(); entry != shard->entries.rend(); ++entry)
+        {
+            puzzle.loadGivens(entry->puzzle.data());
+            solved.loadGivens(entry->solution.data());
+            writer.add(puzzle, &solved);
+        }
+    }
+
+    if (!writer.close())
+    {
+        std::cerr << "Error writing file '" << path << "'. \n";
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::size_t SolutionCache::CellsHash::operator()(const Cells& cells) const
+{
+    std::uint64_t hash = 0;
+
+    for (std::size_t i = 0; i < cells.size(); i += sizeof(std::uint64_t))
+    {
+        std::uint64_t word = 0;
+        std::memcpy(&word, cells.data() + i, std::min(sizeof(word), cells.size() - i));
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 29;
+    }
+    return static_cast<std::size_t>(hash);
+}
+
+//------------------------------------------------------------------------------------------
+
+SolutionCache::Shard& SolutionCache::shardFor(const Cells& cells)
+{
+    // The high bits, as the hash tables index by the low ones
+    const std::uint64_t hash = CellsHash{}(cells);
+    return *shards[(hash >> 40) % shards.size()];
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "sudoku.hpp"
+#include "sudoku_canonical.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//------------------------------------------------------------------------------------------
+
+// Bounded cache of solved puzzles, keyed by the canonical form of their givens, so a puzzle
+// that is a rotation, reflection, relabelling or band permutation of a solved one is a hit.
+// Solutions are kept in the canonical frame and mapped back through the transform of the
+// puzzle being looked up. The cache is split into shards, each with its own lock and
+// least-recently-used list, so worker threads rarely contend.
+
+class SolutionCache
+{
+public:
+    // capacity is the most solutions kept over all shards. It is split as evenly as it goes,
+    // and a capacity below shardCount gets one shard per solution.
+    explicit SolutionCache(std::size_t capacity, int shardCount = DefaultShardCount);
+
+    // On a hit, fills the answers of sudoku, whose givens have the canonical form given,
+    // and returns true
+    bool lookup(const CanonicalForm&, Sudoku&);
+    // Stores the solution of solved, whose givens have the canonical form given. Only puzzles
+    // with a unique solution belong here: any other solution would be handed out for every
+    // equivalent puzzle, whichever was solved first.
+    void insert(const CanonicalForm&, const Sudoku& solved);
+
+    std::uint64_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+    std::uint64_t misses() const { return missCount.load(std::memory_order_relaxed); }
+    std::size_t size() const;
+
+    // The cache persists as a puzzle archive of canonical puzzles with their solutions,
+    // shard by shard and least recently used first within each. Loading skips puzzles
+    // without a unique solution. Both return false, reporting why on stderr, on failure.
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    static constexpr int DefaultShardCount = 16;
+
+private:
+    using Cells = std::array<std::uint8_t, SudokuUnits::CellCount>;
+
+    struct CellsHash
+    {
+        std::size_t operator()(const Cells&) const;
+    };
+
+    struct Entry
+    {
+        Cells puzzle;
+        Cells solution;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        // Most solutions kept in this shard
+        std::size_t capacity = 0;
+        // Most recently used first
+        std::list<Entry> entries;
+        std::unordered_map<Cells, std::list<Entry>::iterator, CellsHash> index;
+    };
+
+    Shard& shardFor(const Cells&);
+    void insertCanonical(const Cells& puzzle, const Cells& solution);
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    std::atomic<std::uint64_t> hitCount{0};
+    std::atomic<std::uint64_t> missCount{0};
+};
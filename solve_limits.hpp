@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------
+
+// Lets another thread stop a solve that is running under SolveLimits
+class CancelToken
+{
+public:
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> cancelled{false};
+};
+
+//------------------------------------------------------------------------------------------
+
+// Bounds on a single solve; the defaults leave it unbounded
+struct SolveLimits
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    // Search nodes the solve may enter, 0 for no limit
+    std::uint64_t maxNodes = 0;
+    const CancelToken* cancelToken = nullptr;
+
+    // Deadline this far from now
+    static SolveLimits timeBudget(std::chrono::nanoseconds budget)
+    {
+        SolveLimits limits;
+        limits.deadline = std::chrono::steady_clock::now() + budget;
+        return limits;
+    }
+};
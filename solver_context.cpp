@@ -0,0 +1,9 @@
+#include "solver_context.hpp"
+
+//------------------------------------------------------------------------------------------
+
+SolverContext& SolverContext::forThisThread()
+{
+    thread_local SolverContext context;
+    return context;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "dlx_solver.hpp"
+#include "iterative_solver.hpp"
+#include "propagation_solver.hpp"
+
+//------------------------------------------------------------------------------------------
+
+// Scratch state of the 9x9 solvers: one solver of each strategy, with its candidate masks,
+// trail and node pool, built once and reused for every later puzzle. Sudoku::solve and
+// countSolutions use the context of the calling thread, so a thread working through a
+// stream of puzzles neither allocates nor rebuilds solver state per puzzle.
+
+struct SolverContext
+{
+    PropagationSolver propagation;
+    IterativeSolver iterative;
+    DlxSolver dlx;
+
+    // Built on first use in each thread
+    static SolverContext& forThisThread();
+};
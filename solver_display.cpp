@@ -0,0 +1,131 @@
+#include "solver_display.hpp"
+
+#include "sudoku.hpp"
+
+#include <iostream>
+
+//------------------------------------------------------------------------------------------
+
+SolverDisplay::SolverDisplay(const Sudoku& sud) : sudoku(sud)
+{
+    for (int i = 0; i < CellCount; ++i)
+    {
+        cells[i].store(sudoku.values[i], std::memory_order_relaxed);
+    }
+    painted.fill(NotPainted);
+}
+
+//------------------------------------------------------------------------------------------
+
+SolverDisplay::~SolverDisplay()
+{
+    stop();
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverDisplay::start()
+{
+    // Clear the screen and home the cursor with escape codes, rather than forking a shell
+    std::cout << "\033[2J\033[H" << sudoku << std::flush;
+
+    for (int i = 0; i < CellCount; ++i)
+    {
+        painted[i] = cells[i].load(std::memory_order_relaxed);
+    }
+
+    stopping = false;
+    painter = std::thread(&SolverDisplay::run, this);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverDisplay::stop()
+{
+    if (!painter.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    painter.join();
+
+    paintChangedCells();
+
+    // Below the last separator and the blank line that follows the board
+    const int lastRow = screenRow(Sudoku::MaxCoord) + 1;
+    std::cout << "\033[" << (lastRow + 2) << ";1H" << std::flush;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverDisplay::run()
+{
+    const auto framePeriod = std::chrono::microseconds(1000000 / FramesPerSecond);
+    auto nextFrame = std::chrono::steady_clock::now() + framePeriod;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!wake.wait_until(lock, nextFrame, [this] { return stopping; }))
+    {
+        paintChangedCells();
+        nextFrame += framePeriod;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverDisplay::paintChangedCells()
+{
+    frame.clear();
+
+    for (int i = 0; i < CellCount; ++i)
+    {
+        const std::uint8_t value = cells[i].load(std::memory_order_relaxed);
+
+        if (value == painted[i])
+        {
+            continue;
+        }
+        painted[i] = value;
+
+        const int rowIndex = i / Sudoku::SudokuWidth;
+        const int colIndex = i % Sudoku::SudokuWidth;
+
+        // Givens never change, so only the colours of entered digits and empty cells are needed
+        frame += "\033[";
+        frame += std::to_string(screenRow(rowIndex));
+        frame += ';';
+        frame += std::to_string(screenColumn(colIndex));
+        frame += (value == Sudoku::NoValue) ? "H\033[31m" : "H\033[32m";
+        frame += static_cast<char>('0' + value);
+        frame += "\033[0m";
+    }
+
+    if (!frame.empty())
+    {
+        std::cout.write(frame.data(), static_cast<std::streamsize>(frame.size()));
+        std::cout.flush();
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+int SolverDisplay::screenRow(int rowIndex) const
+{
+    // Coordinate row, padding rows, then a separator above every row and a second one above each box
+    return 1 + sudoku.padding + 2 * rowIndex + (rowIndex / Sudoku::BoxWidth) + 2;
+}
+
+//------------------------------------------------------------------------------------------
+
+int SolverDisplay::screenColumn(int colIndex) const
+{
+    // Row label, padding and separator, then the cells before this one with a bar opening each box
+    const int cellWidth = 2 * sudoku.padding + 2;
+    return 1 + (2 + sudoku.padding) + colIndex * cellWidth + (colIndex / Sudoku::BoxWidth) + 1 + sudoku.padding;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+template <int BoxSize>
+class BasicSudoku;
+using Sudoku = BasicSudoku<3>;
+
+//------------------------------------------------------------------------------------------
+
+// Shows a running solver without slowing it down. The solver only publishes each placement
+// into an atomic copy of the board; a separate thread samples that copy at a fixed frame
+// rate and repaints the cells that changed since the last frame, using ANSI cursor moves
+// over a board drawn once at the start.
+
+class SolverDisplay
+{
+public:
+    static constexpr int FramesPerSecond = 30;
+
+    explicit SolverDisplay(const Sudoku&);
+    ~SolverDisplay();
+
+    SolverDisplay(const SolverDisplay&) = delete;
+    SolverDisplay& operator=(const SolverDisplay&) = delete;
+
+    // Draws the whole board and starts repainting it in the background
+    void start();
+    // Paints the final state and leaves the cursor below the board
+    void stop();
+
+    // Called by the solver on every placement, 0 when a cell is cleared
+    void publish(int cellIndex, int value) { cells[cellIndex].store(static_cast<std::uint8_t>(value), std::memory_order_relaxed); }
+
+private:
+    static constexpr int CellCount = 81;
+    static constexpr int NotPainted = 0xff;
+
+    void run();
+    void paintChangedCells();
+
+    // 1-based terminal row and column of a cell's digit
+    int screenRow(int rowIndex) const;
+    int screenColumn(int colIndex) const;
+
+    const Sudoku& sudoku;
+
+    std::array<std::atomic<std::uint8_t>, CellCount> cells;
+    std::array<std::uint8_t, CellCount> painted;
+
+    std::string frame;
+
+    std::thread painter;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
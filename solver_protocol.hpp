@@ -0,0 +1,107 @@
+#pragma once
+
+#include "sudoku_units.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//------------------------------------------------------------------------------------------
+
+// Messages of the solver daemon's Unix socket protocol, shared by the server and the load
+// generator. Every message is a 4-byte little-endian length followed by that many bytes:
+//
+//   request:  u32 id, u8 RequestType, then for Solve the 81 cells of the puzzle, row-major,
+//             0 for an empty cell
+//   response: u32 id, u8 Status, then for a solved puzzle the 81 cells of the solution, or
+//             for Stats the counters as one line of text
+//
+// Ids are picked by the client and echoed back. A connection may have many requests in
+// flight, and their responses come back in the order they finish, not the order sent.
+
+struct SolverProtocol
+{
+    enum class RequestType : std::uint8_t
+    {
+        Solve = 1,
+        // Request count and latency percentiles of the server
+        Stats = 2,
+    };
+
+    enum class Status : std::uint8_t
+    {
+        Ok = 0,
+        NoSolution = 1,
+        // A cell out of range, or givens that repeat a digit in a unit
+        InvalidPuzzle = 2,
+        // The solve ran past the server's time or node budget
+        OverBudget = 3,
+        // Unknown request type or wrong length
+        BadRequest = 4,
+        // The solver gave back a board that is not a solution; the server logs the puzzle
+        InternalError = 5,
+    };
+    static constexpr int StatusCount = 6;
+
+    static constexpr std::size_t LengthBytes = 4;
+    // Id and type or status
+    static constexpr std::size_t HeaderBytes = 5;
+    static constexpr std::size_t CellCount = SudokuUnits::CellCount;
+    // Longest body a server accepts; anything longer drops the connection
+    static constexpr std::size_t MaxMessageBytes = 1024;
+
+    static void storeU32(std::uint8_t* bytes, std::uint32_t value)
+    {
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            bytes[i] = static_cast<std::uint8_t>(value >> (8 * i));
+        }
+    }
+
+    static std::uint32_t loadU32(const std::uint8_t* bytes)
+    {
+        std::uint32_t value = 0;
+
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            value |= static_cast<std::uint32_t>(bytes[i]) << (8 * i);
+        }
+        return value;
+    }
+
+    // Appends a whole message with the given id, type or status byte and body
+    static void appendMessage(std::string& out, std::uint32_t id, std::uint8_t code, const void* body, std::size_t length)
+    {
+        std::uint8_t header[LengthBytes + HeaderBytes];
+        storeU32(header, static_cast<std::uint32_t>(HeaderBytes + length));
+        storeU32(header + LengthBytes, id);
+        header[LengthBytes + 4] = code;
+
+        out.append(reinterpret_cast<const char*>(header), sizeof(header));
+        if (length > 0)
+        {
+            out.append(static_cast<const char*>(body), length);
+        }
+    }
+
+    // Returns the length of the first whole message in bytes, length prefix included, or 0
+    // if more bytes are needed. Sets malformed if the length prefix can never be valid.
+    static std::size_t messageLength(const std::string& buffer, std::size_t offset, bool& malformed)
+    {
+        malformed = false;
+
+        if (buffer.size() - offset < LengthBytes)
+        {
+            return 0;
+        }
+
+        const std::uint32_t length = loadU32(reinterpret_cast<const std::uint8_t*>(buffer.data() + offset));
+
+        if ((length < HeaderBytes) || (length > MaxMessageBytes))
+        {
+            malformed = true;
+            return 0;
+        }
+        return (buffer.size() - offset >= LengthBytes + length) ? LengthBytes + length : 0;
+    }
+};
@@ -0,0 +1,716 @@
+#include "solver_server.hpp"
+
+#include "sudoku_validator.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+    #include <sys/epoll.h>
+    #include <sys/eventfd.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::setThreadCount(int count)
+{
+    threadCount = std::max(count, 1);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::setBudgets(std::chrono::milliseconds time, std::uint64_t nodes)
+{
+    timeBudget = time;
+    nodeBudget = nodes;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::solve(Worker& worker, const Request& request, Response& response)
+{
+    response.connection = request.connection;
+    response.id = request.id;
+    response.received = request.received;
+    response.cells = request.cells;
+
+    const bool inRange = std::all_of(request.cells.begin(), request.cells.end(),
+                                     [](std::uint8_t value) { return value <= Sudoku::MaxValue; });
+
+    if (!inRange)
+    {
+        response.status = SolverProtocol::Status::InvalidPuzzle;
+        return;
+    }
+
+    Sudoku& sudoku = worker.sudoku;
+    sudoku.loadGivens(request.cells.data());
+
+    if (!sudoku.isValid())
+    {
+        response.status = SolverProtocol::Status::InvalidPuzzle;
+        return;
+    }
+
+    if ((timeBudget.count() == 0) && (nodeBudget == 0))
+    {
+        const bool solved = showStats ? sudoku.solve(worker.stats) : sudoku.solve();
+        response.status = solved ? SolverProtocol::Status::Ok : SolverProtocol::Status::NoSolution;
+    }
+    else
+    {
+        SolveLimits limits;
+        limits.maxNodes = nodeBudget;
+
+        if (timeBudget.count() > 0)
+        {
+            limits.deadline = Clock::now() + timeBudget;
+        }
+
+        switch (showStats ? sudoku.solve(limits, worker.stats) : sudoku.solve(limits))
+        {
+            case Sudoku::SolveResult::Solved:       response.status = SolverProtocol::Status::Ok;         break;
+            case Sudoku::SolveResult::Unsolvable:   response.status = SolverProtocol::Status::NoSolution; break;
+            case Sudoku::SolveResult::LimitReached: response.status = SolverProtocol::Status::OverBudget; break;
+        }
+    }
+
+    // Never send back a board that is not a solution. That is a solver bug, not something
+    // about the puzzle, so it gets its own status and the puzzle is logged.
+    if ((response.status == SolverProtocol::Status::Ok) && !SudokuValidator::check(sudoku.cells()).done())
+    {
+        response.status = SolverProtocol::Status::InternalError;
+
+        char line[Sudoku::LineLength];
+        sudoku.loadGivens(request.cells.data());
+        sudoku.writeToLine(line);
+        std::cerr << "Request " + std::to_string(request.id) + ": the solver's answer is not a solution of "
+                     + std::string(line, sizeof(line)) + ". \n";
+    }
+
+    if (response.status == SolverProtocol::Status::Ok)
+    {
+        std::copy_n(sudoku.cells(), response.cells.size(), response.cells.begin());
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::runWorker(int index)
+{
+    Worker& worker = *workers[index];
+    Batch batch;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(batchMutex);
+
+            // The last batch goes back to the I/O thread for reuse
+            if (batch.capacity() > 0)
+            {
+                batch.clear();
+                spareBatches.push_back(std::move(batch));
+            }
+
+            batchAvailable.wait(lock, [this] { return stopping || (nextBatch < batches.size()); });
+
+            if (nextBatch == batches.size())
+            {
+                return;
+            }
+            batch = std::move(batches[nextBatch++]);
+
+            if (nextBatch == batches.size())
+            {
+                batches.clear();
+                nextBatch = 0;
+            }
+        }
+
+        worker.responses.resize(batch.size());
+
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            solve(worker, batch[i], worker.responses[i]);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(responseMutex);
+            finished.insert(finished.end(), worker.responses.begin(), worker.responses.end());
+        }
+
+        #ifdef __linux__
+            const std::uint64_t one = 1;
+            [[maybe_unused]] const ssize_t written = write(wakeFd, &one, sizeof(one));
+        #endif
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::submitPending()
+{
+    if (pending.empty())
+    {
+        return;
+    }
+
+    // Spread a small wakeup over the workers, and cap the batches of a large one
+    const std::size_t perWorker = (pending.size() + threadCount - 1) / static_cast<std::size_t>(threadCount);
+    const std::size_t batchSize = std::clamp<std::size_t>(perWorker, 1, MaxBatch);
+
+    {
+        std::lock_guard<std::mutex> lock(batchMutex);
+
+        for (std::size_t first = 0; first < pending.size(); first += batchSize)
+        {
+            const std::size_t last = std::min(first + batchSize, pending.size());
+            Batch batch;
+
+            if (!spareBatches.empty())
+            {
+                batch = std::move(spareBatches.back());
+                spareBatches.pop_back();
+            }
+            batch.assign(pending.begin() + first, pending.begin() + last);
+            batches.push_back(std::move(batch));
+            ++batchCount;
+        }
+    }
+    batchAvailable.notify_all();
+
+    batchedRequests += pending.size();
+    pending.clear();
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::printSummary(std::ostream& os) const
+{
+    const std::chrono::duration<double> uptime = Clock::now() - started;
+    const std::uint64_t answered = latency.count();
+
+    os << "requests " << answered
+       << " ok " << statusCounts[static_cast<int>(SolverProtocol::Status::Ok)]
+       << " unsolvable " << statusCounts[static_cast<int>(SolverProtocol::Status::NoSolution)]
+       << " invalid " << statusCounts[static_cast<int>(SolverProtocol::Status::InvalidPuzzle)]
+       << " over_budget " << statusCounts[static_cast<int>(SolverProtocol::Status::OverBudget)]
+       << " bad " << statusCounts[static_cast<int>(SolverProtocol::Status::BadRequest)]
+       << " internal " << statusCounts[static_cast<int>(SolverProtocol::Status::InternalError)]
+       << " connections " << connectionCount
+       << " batches " << batchCount
+       << " mean_batch " << ((batchCount > 0) ? static_cast<double>(batchedRequests) / static_cast<double>(batchCount) : 0.0)
+       << " p50_us " << latency.percentile(0.50)
+       << " p99_us " << latency.percentile(0.99)
+       << " max_us " << latency.max()
+       << " uptime_s " << uptime.count();
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::printStats() const
+{
+    SolverStats total;
+    total.recordDepthHistogram = true;
+
+    for (const auto& worker : workers)
+    {
+        total += worker->stats;
+    }
+
+    std::cerr << "Solver statistics over all puzzles: \n" << total;
+}
+
+#ifdef __linux__
+
+//------------------------------------------------------------------------------------------
+
+// Written by the signal handler to stop the I/O loop
+static int stopEventFd = -1;
+
+static void requestStop(int)
+{
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const ssize_t written = write(stopEventFd, &one, sizeof(one));
+}
+
+//------------------------------------------------------------------------------------------
+
+int SolverServer::exec()
+{
+    if (!openSocket())
+    {
+        closeSocket();
+        return 1;
+    }
+
+    stopEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    epoll_event stopEvent{};
+    stopEvent.events = EPOLLIN;
+    stopEvent.data.u64 = StopTag;
+
+    if ((stopEventFd < 0) || (epoll_ctl(epollFd, EPOLL_CTL_ADD, stopEventFd, &stopEvent) != 0))
+    {
+        std::cerr << "Error creating stop event: " << std::strerror(errno) << ". \n";
+        closeSocket();
+        return 1;
+    }
+
+    struct sigaction action{};
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    for (int i = 0; i < threadCount; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->sudoku.setSolverStrategy(solverStrategy);
+        workers.back()->sudoku.setTechniques(techniques);
+        workers.back()->stats.recordDepthHistogram = showStats;
+    }
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(&SolverServer::runWorker, this, i);
+    }
+
+    std::cerr << "Serving on '" << socketPath << "' with " << threadCount << " workers. \n";
+    started = Clock::now();
+    runIo();
+
+    {
+        std::lock_guard<std::mutex> lock(batchMutex);
+        stopping = true;
+    }
+    batchAvailable.notify_all();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    printSummary(std::cerr);
+    std::cerr << "\n";
+
+    if (showStats)
+    {
+        printStats();
+    }
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    close(stopEventFd);
+    stopEventFd = -1;
+    closeSocket();
+    return 0;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SolverServer::openSocket()
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+
+    if (socketPath.empty() || (socketPath.size() >= sizeof(address.sun_path)))
+    {
+        std::cerr << "Socket path '" << socketPath << "' must be 1 to " << sizeof(address.sun_path) - 1 << " characters. \n";
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    // A socket file left by a server that did not shut down cleanly would block the bind
+    unlink(socketPath.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+    if ((listenFd < 0) || (bind(listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        || (listen(listenFd, SOMAXCONN) != 0))
+    {
+        std::cerr << "Error listening on '" << socketPath << "': " << std::strerror(errno) << ". \n";
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    epoll_event listenEvent{};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.u64 = ListenTag;
+
+    epoll_event wakeEvent{};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.u64 = WakeTag;
+
+    if ((epollFd < 0) || (wakeFd < 0) || (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &listenEvent) != 0)
+        || (epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &wakeEvent) != 0))
+    {
+        std::cerr << "Error setting up epoll: " << std::strerror(errno) << ". \n";
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::closeSocket()
+{
+    while (!connections.empty())
+    {
+        closeConnection(connections.begin()->first);
+    }
+
+    for (int* fd : { &wakeFd, &epollFd, &listenFd })
+    {
+        if (*fd >= 0)
+        {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+
+    if (!socketPath.empty())
+    {
+        unlink(socketPath.c_str());
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::runIo()
+{
+    epoll_event events[MaxEvents];
+
+    while (true)
+    {
+        const int eventCount = epoll_wait(epollFd, events, MaxEvents, -1);
+
+        if (eventCount < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            std::cerr << "Error waiting for events: " << std::strerror(errno) << ". \n";
+            return;
+        }
+
+        for (int i = 0; i < eventCount; ++i)
+        {
+            const std::uint64_t tag = events[i].data.u64;
+
+            if (tag == StopTag)
+            {
+                return;
+            }
+            if (tag == ListenTag)
+            {
+                acceptConnections();
+                continue;
+            }
+            if (tag == WakeTag)
+            {
+                std::uint64_t count = 0;
+                [[maybe_unused]] const ssize_t readBytes = read(wakeFd, &count, sizeof(count));
+                collectResponses();
+                continue;
+            }
+
+            const auto connectionIt = connections.find(tag);
+            if (connectionIt == connections.end())
+            {
+                continue;
+            }
+
+            Connection& connection = connectionIt->second;
+            bool open = true;
+
+            if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            {
+                open = readConnection(tag, connection);
+            }
+            if (open && (events[i].events & EPOLLOUT))
+            {
+                open = flushConnection(tag, connection);
+            }
+            if (!open)
+            {
+                closeConnection(tag);
+            }
+        }
+
+        submitPending();
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::acceptConnections()
+{
+    while (true)
+    {
+        const int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0)
+        {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR))
+            {
+                std::cerr << "Error accepting connection: " << std::strerror(errno) << ". \n";
+            }
+            return;
+        }
+
+        const std::uint64_t id = nextConnection++;
+        Connection& connection = connections[id];
+        connection.fd = fd;
+        connection.events = EPOLLIN;
+
+        epoll_event event{};
+        event.events = connection.events;
+        event.data.u64 = id;
+
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            closeConnection(id);
+            continue;
+        }
+        ++connectionCount;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SolverServer::readConnection(std::uint64_t id, Connection& connection)
+{
+    char buffer[1 << 16];
+    const ssize_t length = recv(connection.fd, buffer, sizeof(buffer), 0);
+
+    if (length == 0)
+    {
+        return false;
+    }
+    if (length < 0)
+    {
+        return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+    }
+
+    connection.input.append(buffer, static_cast<std::size_t>(length));
+
+    if (!parseRequests(id, connection))
+    {
+        return false;
+    }
+    return flushConnection(id, connection);
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SolverServer::parseRequests(std::uint64_t id, Connection& connection)
+{
+    const Clock::time_point now = Clock::now();
+    std::size_t offset = 0;
+    bool malformed = false;
+
+    while (const std::size_t length = SolverProtocol::messageLength(connection.input, offset, malformed))
+    {
+        const auto* message = reinterpret_cast<const std::uint8_t*>(connection.input.data() + offset + SolverProtocol::LengthBytes);
+        const std::size_t bodyLength = length - SolverProtocol::LengthBytes - SolverProtocol::HeaderBytes;
+        const std::uint32_t requestId = SolverProtocol::loadU32(message);
+        const auto type = static_cast<SolverProtocol::RequestType>(message[4]);
+        offset += length;
+
+        if ((type == SolverProtocol::RequestType::Solve) && (bodyLength == SolverProtocol::CellCount))
+        {
+            Request& request = pending.emplace_back();
+            request.connection = id;
+            request.id = requestId;
+            request.received = now;
+            std::copy_n(message + SolverProtocol::HeaderBytes, request.cells.size(), request.cells.begin());
+            ++connection.inFlight;
+        }
+        else if ((type == SolverProtocol::RequestType::Stats) && (bodyLength == 0))
+        {
+            answerStats(id, connection, requestId);
+        }
+        else
+        {
+            ++statusCounts[static_cast<int>(SolverProtocol::Status::BadRequest)];
+            SolverProtocol::appendMessage(connection.output, requestId,
+                                          static_cast<std::uint8_t>(SolverProtocol::Status::BadRequest), nullptr, 0);
+        }
+    }
+
+    connection.input.erase(0, offset);
+    return !malformed;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::answerStats(std::uint64_t, Connection& connection, std::uint32_t requestId)
+{
+    std::ostringstream text;
+    printSummary(text);
+    const std::string line = text.str();
+
+    SolverProtocol::appendMessage(connection.output, requestId, static_cast<std::uint8_t>(SolverProtocol::Status::Ok),
+                                  line.data(), std::min(line.size(), SolverProtocol::MaxMessageBytes - SolverProtocol::HeaderBytes));
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::collectResponses()
+{
+    collected.clear();
+    {
+        std::lock_guard<std::mutex> lock(responseMutex);
+        collected.swap(finished);
+    }
+
+    const Clock::time_point now = Clock::now();
+    answered.clear();
+
+    for (const Response& response : collected)
+    {
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now - response.received);
+        latency.record(static_cast<std::uint64_t>(micros.count()));
+        ++statusCounts[static_cast<int>(response.status)];
+
+        const auto connectionIt = connections.find(response.connection);
+        if (connectionIt == connections.end())
+        {
+            continue;
+        }
+        --connectionIt->second.inFlight;
+
+        const bool solved = (response.status == SolverProtocol::Status::Ok);
+        SolverProtocol::appendMessage(connectionIt->second.output, response.id, static_cast<std::uint8_t>(response.status),
+                                      response.cells.data(), solved ? response.cells.size() : 0);
+
+        if (answered.empty() || (answered.back() != response.connection))
+        {
+            answered.push_back(response.connection);
+        }
+    }
+
+    for (const std::uint64_t id : answered)
+    {
+        const auto connectionIt = connections.find(id);
+
+        if ((connectionIt != connections.end()) && !flushConnection(id, connectionIt->second))
+        {
+            closeConnection(id);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SolverServer::flushConnection(std::uint64_t id, Connection& connection)
+{
+    while (connection.outputSent < connection.output.size())
+    {
+        const ssize_t sent = send(connection.fd, connection.output.data() + connection.outputSent,
+                                  connection.output.size() - connection.outputSent, MSG_NOSIGNAL);
+
+        if (sent > 0)
+        {
+            connection.outputSent += static_cast<std::size_t>(sent);
+        }
+        else if ((sent < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        else if ((sent < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK)))
+        {
+            break;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if (connection.outputSent == connection.output.size())
+    {
+        connection.output.clear();
+        connection.outputSent = 0;
+    }
+    else if (connection.outputSent > connection.output.size() / 2)
+    {
+        connection.output.erase(0, connection.outputSent);
+        connection.outputSent = 0;
+    }
+
+    return updateEvents(id, connection);
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SolverServer::updateEvents(std::uint64_t id, Connection& connection)
+{
+    const std::size_t queued = connection.output.size() - connection.outputSent;
+    std::uint32_t wanted = 0;
+
+    if ((queued < MaxQueuedOutput) && (connection.inFlight < MaxInFlight))
+    {
+        wanted |= EPOLLIN;
+    }
+    if (queued > 0)
+    {
+        wanted |= EPOLLOUT;
+    }
+
+    if (wanted == connection.events)
+    {
+        return true;
+    }
+
+    epoll_event event{};
+    event.events = wanted;
+    event.data.u64 = id;
+    connection.events = wanted;
+    return epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event) == 0;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SolverServer::closeConnection(std::uint64_t id)
+{
+    const auto connectionIt = connections.find(id);
+
+    if (connectionIt == connections.end())
+    {
+        return;
+    }
+
+    // Closing the descriptor also takes it out of the epoll set. Responses still being
+    // solved for it are dropped when they come back.
+    close(connectionIt->second.fd);
+    connections.erase(connectionIt);
+}
+
+#else
+
+//------------------------------------------------------------------------------------------
+
+int SolverServer::exec()
+{
+    std::cerr << "Server mode needs epoll and Unix domain sockets, which are only supported on Linux. \n";
+    return 1;
+}
+
+#endif
@@ -0,0 +1,172 @@
+#pragma once
+
+#include "latency_histogram.hpp"
+#include "solver_protocol.hpp"
+#include "sudoku.hpp"
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//------------------------------------------------------------------------------------------
+
+// Long-running solver daemon on a Unix domain socket, speaking SolverProtocol. One I/O
+// thread owns every connection and waits on them with epoll. The requests that arrive in
+// one wakeup, from any number of connections, are cut into batches and handed to a pool of
+// workers, each with its own warm Sudoku; a worker solves a whole batch before handing the
+// responses back, so the locking and wakeups are paid per batch rather than per puzzle.
+// Latency is measured from a request being read to its response being queued for writing,
+// and is reported to Stats requests and on shutdown. Runs until SIGINT or SIGTERM.
+// Only built for Linux, as it needs epoll; elsewhere exec reports an error.
+
+class SolverServer
+{
+public:
+    int exec();
+
+    void setSocketPath(const std::string& path) { socketPath = path; }
+    void setSolverStrategy(Sudoku::SolverStrategy strategy) { solverStrategy = strategy; }
+    void setTechniques(TechniqueMask mask) { techniques = mask; }
+    void setThreadCount(int count);
+    // Puzzles that outrun either budget are answered with OverBudget; 0 turns a budget off
+    void setBudgets(std::chrono::milliseconds time, std::uint64_t nodes);
+    // Collects solver statistics over every solve and prints them on shutdown
+    void setShowStats(bool status) { showStats = status; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    using Cells = std::array<std::uint8_t, SolverProtocol::CellCount>;
+
+    struct Request
+    {
+        std::uint64_t connection = 0;
+        std::uint32_t id = 0;
+        Clock::time_point received;
+        Cells cells{};
+    };
+
+    struct Response
+    {
+        std::uint64_t connection = 0;
+        std::uint32_t id = 0;
+        Clock::time_point received;
+        SolverProtocol::Status status = SolverProtocol::Status::Ok;
+        Cells cells{};
+    };
+
+    using Batch = std::vector<Request>;
+
+    struct Connection
+    {
+        int fd = -1;
+        // Bytes read but not yet parsed into requests
+        std::string input;
+        // Bytes queued for writing, of which the first outputSent have gone
+        std::string output;
+        std::size_t outputSent = 0;
+        // Solve requests parsed but not yet answered
+        std::size_t inFlight = 0;
+        // epoll events currently watched
+        std::uint32_t events = 0;
+    };
+
+    struct Worker
+    {
+        Sudoku sudoku;
+        SolverStats stats;
+        std::vector<Response> responses;
+    };
+
+    bool openSocket();
+    void closeSocket();
+
+    void runIo();
+    void runWorker(int index);
+
+    void acceptConnections();
+    // Returns false once the connection should be closed
+    bool readConnection(std::uint64_t id, Connection&);
+    bool parseRequests(std::uint64_t id, Connection&);
+    bool flushConnection(std::uint64_t id, Connection&);
+    // Watches for writes while output is queued, and stops reading while too much is, or
+    // while too many requests are waiting for a worker
+    bool updateEvents(std::uint64_t id, Connection&);
+    void closeConnection(std::uint64_t id);
+
+    // Cuts the requests read in this wakeup into batches for the workers
+    void submitPending();
+    void collectResponses();
+    void solve(Worker&, const Request&, Response&);
+    void answerStats(std::uint64_t id, Connection&, std::uint32_t requestId);
+
+    void printSummary(std::ostream&) const;
+    // Only once the workers have stopped
+    void printStats() const;
+
+    std::string socketPath;
+    Sudoku::SolverStrategy solverStrategy = Sudoku::SolverStrategy::Propagation;
+    TechniqueMask techniques = AllTechniques;
+    int threadCount = 1;
+    std::chrono::milliseconds timeBudget{0};
+    std::uint64_t nodeBudget = 0;
+    bool showStats = false;
+
+    int listenFd = -1;
+    int epollFd = -1;
+    // Signalled by the workers when responses are ready
+    int wakeFd = -1;
+
+    std::unordered_map<std::uint64_t, Connection> connections;
+    std::uint64_t nextConnection = FirstConnection;
+    Batch pending;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex batchMutex;
+    std::condition_variable batchAvailable;
+    // Batches waiting for a worker, taken in order from nextBatch
+    std::vector<Batch> batches;
+    std::size_t nextBatch = 0;
+    // Batches the workers have finished, kept with their capacity for later wakeups, so
+    // steady serving allocates nothing per request
+    std::vector<Batch> spareBatches;
+    bool stopping = false;
+
+    std::mutex responseMutex;
+    std::vector<Response> finished;
+
+    // Only touched by the I/O thread
+    // Responses being written out, swapped with finished so both keep their capacity
+    std::vector<Response> collected;
+    // Connections that got responses in this wakeup
+    std::vector<std::uint64_t> answered;
+    LatencyHistogram latency;
+    std::array<std::uint64_t, SolverProtocol::StatusCount> statusCounts{};
+    std::uint64_t batchCount = 0;
+    std::uint64_t batchedRequests = 0;
+    std::uint64_t connectionCount = 0;
+    Clock::time_point started;
+
+    // epoll tags of the listening socket and the wake and stop events; connections follow
+    static constexpr std::uint64_t ListenTag = 0;
+    static constexpr std::uint64_t WakeTag = 1;
+    static constexpr std::uint64_t StopTag = 2;
+    static constexpr std::uint64_t FirstConnection = 16;
+
+    static constexpr std::size_t MaxBatch = 64;
+    static constexpr int MaxEvents = 64;
+    // Stop reading from a connection whose unsent responses pass this, until it catches up
+    static constexpr std::size_t MaxQueuedOutput = 1 << 20;
+    // Stop reading from a connection with this many unanswered requests, until some are
+    // answered. Requests already read are still parsed, so a connection may go past it by
+    // one read's worth.
+    static constexpr std::size_t MaxInFlight = 4 * MaxBatch;
+};
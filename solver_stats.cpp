@@ -0,0 +1,71 @@
+#include "solver_stats.hpp"
+
+#include <iostream>
+
+//------------------------------------------------------------------------------------------
+
+SolverStats& SolverStats::operator+=(const SolverStats& other)
+{
+    guesses += other.guesses;
+    backtracks += other.backtracks;
+    nakedSingles += other.nakedSingles;
+    hiddenSingles += other.hiddenSingles;
+    nodes += other.nodes;
+    placements += other.placements;
+    maxDepth = std::max(maxDepth, other.maxDepth);
+    propagationSteps += other.propagationSteps;
+    wallTime += other.wallTime;
+
+    for (int technique = 0; technique < TechniqueCount; ++technique)
+    {
+        techniques[technique] += other.techniques[technique];
+    }
+    for (int depth = 0; depth <= MaxDepth; ++depth)
+    {
+        depthHistogram[depth] += other.depthHistogram[depth];
+    }
+    return *this;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::ostream& operator<<(std::ostream& os, const SolverStats& stats)
+{
+    os << "Nodes visited:     " << stats.nodes << "\n"
+       << "Placements:        " << stats.placements << " (" << stats.guesses << " guesses, "
+       << stats.nakedSingles << " naked singles, " << stats.hiddenSingles << " hidden singles) \n"
+       << "Backtracks:        " << stats.backtracks << "\n"
+       << "Maximum depth:     " << stats.maxDepth << "\n"
+       << "Propagation steps: " << stats.propagationSteps << "\n"
+       << "Wall time:         " << std::chrono::duration<double, std::milli>(stats.wallTime).count() << " ms \n";
+
+    // Only the deduction solver uses techniques
+    if (std::any_of(stats.techniques.begin(), stats.techniques.end(), [](std::uint64_t count) { return count != 0; }))
+    {
+        os << "Techniques:       ";
+
+        for (int technique = 0; technique < TechniqueCount; ++technique)
+        {
+            if (stats.techniques[technique] != 0)
+            {
+                os << " " << techniqueNames[technique] << ":" << stats.techniques[technique];
+            }
+        }
+        os << "\n";
+    }
+
+    if (stats.recordDepthHistogram)
+    {
+        os << "Nodes per depth:  ";
+
+        for (int depth = 0; depth <= SolverStats::MaxDepth; ++depth)
+        {
+            if (stats.depthHistogram[depth] != 0)
+            {
+                os << " " << depth << ":" << stats.depthHistogram[depth];
+            }
+        }
+        os << "\n";
+    }
+    return os;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "deduction_technique.hpp"
+#include "solve_limits.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+//------------------------------------------------------------------------------------------
+
+// Search effort reported by the solvers. The solvers are templates over the statistics type
+// and record through the member functions below, so solving with NoSolverStats instead
+// compiles every counter away.
+struct SolverStats
+{
+    static constexpr bool Enabled = true;
+    // Deepest possible 9x9 search: one level per cell. Larger boards count anything deeper
+    // in the last histogram bucket.
+    static constexpr int MaxDepth = 81;
+
+    // Trial placements made without being forced
+    std::uint64_t guesses = 0;
+    // Trial placements that were undone after leading to a dead end
+    std::uint64_t backtracks = 0;
+    // Placements forced by propagation: a cell with one candidate left, or a digit with one
+    // cell left in a row, column or box
+    std::uint64_t nakedSingles = 0;
+    std::uint64_t hiddenSingles = 0;
+
+    // Search nodes entered, the root included
+    std::uint64_t nodes = 0;
+    // Digits written by the solver, guessed or forced
+    std::uint64_t placements = 0;
+    int maxDepth = 0;
+    // Propagation work: a placed digit cleared from its peers, or a Dancing Links column cover
+    std::uint64_t propagationSteps = 0;
+
+    // Instances of each deduction technique that eliminated a candidate
+    std::array<std::uint64_t, TechniqueCount> techniques{};
+
+    // Time spent in Sudoku::solve
+    std::chrono::nanoseconds wallTime{0};
+
+    // Nodes entered at each depth, filled only when recordDepthHistogram is set
+    bool recordDepthHistogram = false;
+    std::array<std::uint64_t, MaxDepth + 1> depthHistogram{};
+
+    // Set by Sudoku::solve for the length of a solve under SolveLimits
+    const SolveLimits* limits = nullptr;
+    // Value of nodes at which the node budget runs out
+    std::uint64_t nodeLimit = 0;
+    // Set once the limits have stopped the search
+    bool limitReached = false;
+
+    void enterNode(int depth)
+    {
+        ++nodes;
+        maxDepth = std::max(maxDepth, depth);
+
+        if (recordDepthHistogram)
+        {
+            ++depthHistogram[std::min(depth, MaxDepth)];
+        }
+    }
+
+    void guess() { ++guesses; }
+    void backtrack() { ++backtracks; }
+    void place() { ++placements; }
+    void nakedSingle() { ++nakedSingles; ++placements; }
+    void hiddenSingle() { ++hiddenSingles; ++placements; }
+    void propagationStep() { ++propagationSteps; }
+    void technique(Technique technique, int count) { techniques[static_cast<int>(technique)] += static_cast<std::uint64_t>(count); }
+
+    // Returns true once the search must unwind without finishing. The solvers ask on
+    // entering each node; the clock is only read every few hundred nodes.
+    bool shouldStop()
+    {
+        if ((limits == nullptr) || limitReached)
+        {
+            return limitReached;
+        }
+
+        limitReached = (nodes > nodeLimit)
+                       || ((limits->cancelToken != nullptr) && limits->cancelToken->isCancelled())
+                       || (((nodes % ClockCheckInterval) == 0) && (std::chrono::steady_clock::now() >= limits->deadline));
+        return limitReached;
+    }
+
+    static constexpr std::uint64_t ClockCheckInterval = 256;
+
+    // Adds other's counts to these, keeping the larger maximum depth
+    SolverStats& operator+=(const SolverStats& other);
+};
+
+// Prints a multi-line summary, including the histogram if it was recorded
+std::ostream& operator<<(std::ostream&, const SolverStats&);
+
+//------------------------------------------------------------------------------------------
+
+// Stands in for SolverStats when nothing is to be collected
+struct NoSolverStats
+{
+    static constexpr bool Enabled = false;
+
+    void enterNode(int) {}
+    void guess() {}
+    void backtrack() {}
+    void place() {}
+    void nakedSingle() {}
+    void hiddenSingle() {}
+    void propagationStep() {}
+    void technique(Technique, int) {}
+    static constexpr bool shouldStop() { return false; }
+};
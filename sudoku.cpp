@@ -1,214 +1,652 @@
 #include "sudoku.hpp"
 
+#include "puzzle_scanner.hpp"
+#include "solver_context.hpp"
+#include "solver_display.hpp"
+
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+static_assert(std::is_trivially_copyable_v<BasicSudoku<2>>, "Sudoku must copy with a plain memcpy");
+static_assert(std::is_trivially_copyable_v<BasicSudoku<3>>, "Sudoku must copy with a plain memcpy");
+static_assert(std::is_trivially_copyable_v<BasicSudoku<4>>, "Sudoku must copy with a plain memcpy");
+static_assert(std::is_trivially_copyable_v<BasicSudoku<5>>, "Sudoku must copy with a plain memcpy");
+
 //------------------------------------------------------------------------------------------
 
-void clearScreen()
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::readFromCsv(std::ifstream & file, const char delim)
 {
-    #ifdef _WIN32
-        system("cls");
-    #else
-        system("clear");
-    #endif
+    // Nine rows go through the byte-offset reporting scanner
+    if constexpr (BoxSize == 3)
+    {
+        const std::string text{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        PuzzleScanner scanner(text, PuzzleFormat::Csv, delim);
+
+        switch (scanner.next(*this))
+        {
+            case PuzzleScanner::Result::Error:
+            {
+                const ParseError& error = scanner.error();
+                std::cerr << "Error reading CSV at byte " << error.offset << " (line " << error.line << "): "
+                          << error.message << "." << std::endl;
+                return false;
+            }
+
+            case PuzzleScanner::Result::End:
+                std::cerr << "Error reading CSV; no sudoku found." << std::endl;
+                return false;
+
+            case PuzzleScanner::Result::Puzzle:
+                break;
+        }
+
+        if (scanner.next(*this) != PuzzleScanner::Result::End)
+        {
+            std::cerr << "Error reading CSV; more than 9 rows in CSV." << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+    else
+    {
+        return readCsvRows(file, delim);
+    }
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::readFromCsv(std::ifstream & file, const char delim)
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::readCsvRows(std::ifstream& file, const char delim)
 {
+    std::array<std::uint8_t, CellCount> cells{};
     std::string line;
+    int row = 0;
 
-    for (int rowsRead = 0; rowsRead < SudokuWidth; ++rowsRead)
+    while (std::getline(file, line))
     {
-        if (!getline(file, line))
+        if (!line.empty() && (line.back() == '\r'))
+        {
+            line.pop_back();
+        }
+        if (line.empty())
         {
-            std::cerr << "Error opening file" << std::endl;
+            continue;
+        }
+        if (row == SudokuWidth)
+        {
+            std::cerr << "Error reading CSV; more than " << SudokuWidth << " rows in CSV." << std::endl;
             return false;
         }
 
-        std::istringstream lineStream(line);
-        std::string numAsString;
-        auto columnsRead = 0;
+        std::istringstream fields(line);
+        std::string field;
+        int column = 0;
 
-        while (std::getline(lineStream, numAsString, delim) && columnsRead < SudokuWidth)
+        while (std::getline(fields, field, delim))
         {
-            auto num = NoValue;
-            try
+            // Multi-digit numbers, with any blanks around them
+            const auto first = field.find_first_not_of(" \t");
+            const auto last = field.find_last_not_of(" \t");
+            int value = 0;
+
+            if (first == std::string::npos)
             {
-                num = std::stoi(numAsString);
+                std::cerr << "Error reading CSV; expected a number in row " << row << "." << std::endl;
+                return false;
             }
-            catch (...)
+
+            for (auto i = first; (i <= last) && (value <= MaxValue); ++i)
             {
-                std::cerr << "Failed to convert cell into integer." << std::endl;
-                return false;
+                if ((field[i] < '0') || ('9' < field[i]))
+                {
+                    std::cerr << "Error reading CSV; expected a number in row " << row << "." << std::endl;
+                    return false;
+                }
+                value = value * 10 + (field[i] - '0');
             }
 
-            if ((num < NoValue) || (MaxValue < num))
+            if (value > MaxValue)
             {
-                std::cerr << "Number is out of range." << std::endl;
+                std::cerr << "Error reading CSV; number is out of range in row " << row << "." << std::endl;
                 return false;
             }
-
-            const auto state = (num == NoValue) ? CellState::ToFill : CellState::Fixed;
-
-            grid[rowsRead][columnsRead++] = Cell{ num, state };
+            if (column == SudokuWidth)
+            {
+                std::cerr << "Error reading CSV; more than " << SudokuWidth << " columns in row " << row << "." << std::endl;
+                return false;
+            }
+            cells[row * SudokuWidth + column++] = static_cast<std::uint8_t>(value);
         }
 
-        if ((columnsRead != SudokuWidth) || !lineStream.eof())
+        if (column != SudokuWidth)
         {
-            std::cerr << "Error opening file; not exactly 9 columns read." << std::endl;
+            std::cerr << "Error reading CSV; fewer than " << SudokuWidth << " columns in row " << row << "." << std::endl;
             return false;
         }
+        ++row;
     }
 
-    if (!file.eof())
+    if (row != SudokuWidth)
     {
-        std::cerr << "Error opening file; more than 9 rows in CSV." << std::endl;
+        std::cerr << "Error reading CSV; fewer than " << SudokuWidth << " rows in CSV." << std::endl;
         return false;
     }
 
+    loadGivens(cells.data());
     return true;
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::isValid() const
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::readFromLine(std::string_view line)
 {
-    for (int i = 0; i < SudokuWidth; i++)
+    // Tolerate Windows line endings
+    if (!line.empty() && (line.back() == '\r'))
+    {
+        line.remove_suffix(1);
+    }
+
+    if (line.size() != LineLength)
     {
-        const int boxColIndex = (i * BoxWidth) % SudokuWidth;
-        const int boxRowIndex = (i / BoxWidth) * BoxWidth;
+        return false;
+    }
 
-        if (!isRowValid(i) || !isColumnValid(i) || !isBoxValid(boxRowIndex, boxColIndex))
+    for (int index = 0; index < CellCount; ++index)
+    {
+        const char symbol = line[index];
+        auto num = NoValue;
+
+        if (symbol != '.')
+        {
+            num = symbolValue(symbol);
+
+            if (num < NoValue)
+            {
+                return false;
+            }
+        }
+
+        values[index] = static_cast<std::uint8_t>(num);
+        fixedCells.set(index, num != NoValue);
+    }
+
+    rebuildMasks();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+void BasicSudoku<BoxSize>::writeToLine(char* line) const
+{
+    for (int index = 0; index < CellCount; ++index)
+    {
+        line[index] = (values[index] == NoValue) ? '.' : valueSymbol(values[index]);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+char BasicSudoku<BoxSize>::valueSymbol(int value)
+{
+    return (value < 10) ? static_cast<char>('0' + value) : static_cast<char>('A' + value - 10);
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+int BasicSudoku<BoxSize>::symbolValue(char symbol)
+{
+    int value = -1;
+
+    if (('0' <= symbol) && (symbol <= '9'))
+    {
+        value = symbol - '0';
+    }
+    else if (('A' <= symbol) && (symbol <= 'Z'))
+    {
+        value = symbol - 'A' + 10;
+    }
+    return (value <= MaxValue) ? value : -1;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+void BasicSudoku<BoxSize>::loadGivens(const std::uint8_t* cells)
+{
+    for (int index = 0; index < CellCount; ++index)
+    {
+        values[index] = cells[index];
+        fixedCells.set(index, cells[index] != NoValue);
+    }
+    rebuildMasks();
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+void BasicSudoku<BoxSize>::fillAnswers(const std::uint8_t* solution)
+{
+    for (int index = 0; index < CellCount; ++index)
+    {
+        if (!fixedCells[index])
+        {
+            values[index] = solution[index];
+        }
+    }
+    rebuildMasks();
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::loadPacked(const std::uint8_t* givens, const std::uint8_t* solution)
+{
+    for (int index = 0; index < CellCount; ++index)
+    {
+        const int given = packedValue(givens, index);
+        const int value = ((given == NoValue) && solution) ? packedValue(solution, index) : given;
+
+        if ((given > MaxValue) || (value > MaxValue))
         {
             return false;
         }
+
+        values[index] = static_cast<std::uint8_t>(value);
+        fixedCells.set(index, given != NoValue);
     }
+
+    rebuildMasks();
     return true;
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::isFull() const
+template <int BoxSize>
+void BasicSudoku<BoxSize>::storePacked(std::uint8_t* record) const
 {
-    for (int rowIndex = 0; rowIndex < SudokuWidth; ++rowIndex)
+    if constexpr (PackedBitsPerCell == 4)
     {
-        for (int colIndex = 0; colIndex < SudokuWidth; ++colIndex)
+        for (int index = 0; index + 1 < CellCount; index += 2)
+        {
+            record[index / 2] = static_cast<std::uint8_t>(values[index] | (values[index + 1] << 4));
+        }
+        if ((CellCount % 2) != 0)
         {
-            if (getNumber(rowIndex, colIndex) == NoValue)
+            record[CellCount / 2] = values[CellCount - 1];
+        }
+    }
+    else
+    {
+        std::copy(values.begin(), values.end(), record);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+int BasicSudoku<BoxSize>::packedValue(const std::uint8_t* record, int index)
+{
+    if constexpr (PackedBitsPerCell == 4)
+    {
+        return (record[index / 2] >> ((index % 2) * 4)) & 0xF;
+    }
+    else
+    {
+        return record[index];
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::hasConflict(int rowIndex, int colIndex) const
+{
+    const int value = getNumber(rowIndex, colIndex);
+
+    if (value == NoValue)
+    {
+        return false;
+    }
+
+    return (unitCounts[rowIndex][value] > 1)
+           || (unitCounts[SudokuWidth + colIndex][value] > 1)
+           || (unitCounts[2 * SudokuWidth + boxIndex(rowIndex, colIndex)][value] > 1);
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+std::optional<typename BasicSudoku<BoxSize>::Hint> BasicSudoku<BoxSize>::findHint() const
+{
+    // Candidates are meaningless once a unit holds a digit twice
+    if (!isValid())
+    {
+        return std::nullopt;
+    }
+
+    for (int index = 0; index < CellCount; ++index)
+    {
+        const int rowIndex = index / SudokuWidth;
+        const int colIndex = index % SudokuWidth;
+
+        if (values[index] != NoValue)
+        {
+            continue;
+        }
+
+        const DigitMask options = candidates(rowIndex, colIndex);
+
+        if ((options != 0) && ((options & (options - 1)) == 0))
+        {
+            int value = MinValue;
+            while (digitBit(value) != options)
             {
-                return false;
+                ++value;
             }
+            return Hint{ rowIndex, colIndex, value, Hint::Reason::NakedSingle, 0 };
         }
     }
-    return true;
+
+    for (int unit = 0; unit < UnitCount; ++unit)
+    {
+        for (int value = MinValue; value <= MaxValue; ++value)
+        {
+            if (unitCounts[unit][value] != 0)
+            {
+                continue;
+            }
+
+            int place = -1;
+            int placeCount = 0;
+
+            for (const auto cell : basicUnitCells<BoxSize>[unit])
+            {
+                if ((values[cell] == NoValue) && (candidates(cell / SudokuWidth, cell % SudokuWidth) & digitBit(value)))
+                {
+                    place = cell;
+                    ++placeCount;
+                }
+            }
+
+            if (placeCount == 1)
+            {
+                return Hint{ place / SudokuWidth, place % SudokuWidth, value, Hint::Reason::HiddenSingle, unit };
+            }
+        }
+    }
+    return std::nullopt;
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::isDone() const
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::solve()
 {
-    return (isFull() && isValid());
+    NoSolverStats stats;
+    return solveWith(stats);
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::solve()
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::solve(SolverStats& stats)
 {
-    clearAnswers();
-    return solveRecursive(Sudoku::Coord(0, 0));
+    const auto start = std::chrono::steady_clock::now();
+    const bool solved = solveWith(stats);
+    stats.wallTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return solved;
 }
 
 //------------------------------------------------------------------------------------------
 
-void Sudoku::setSpacePadding(int sp)
+template <int BoxSize>
+typename BasicSudoku<BoxSize>::SolveResult BasicSudoku<BoxSize>::solve(const SolveLimits& limits)
 {
-    if ((sp < PaddingLowerLimit) || (PaddingUpperLimit < sp))
+    SolverStats stats;
+    return solve(limits, stats);
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+typename BasicSudoku<BoxSize>::SolveResult BasicSudoku<BoxSize>::solve(const SolveLimits& limits, SolverStats& stats)
+{
+    // The node budget counts from whatever stats already hold
+    stats.limits = &limits;
+    stats.nodeLimit = (limits.maxNodes == 0) ? std::numeric_limits<std::uint64_t>::max() : stats.nodes + limits.maxNodes;
+    stats.limitReached = false;
+
+    const bool solved = solve(stats);
+    stats.limits = nullptr;
+
+    if (solved)
     {
-        std::cout << "Space padding must be between " << PaddingLowerLimit << " and " << PaddingUpperLimit << ", inclusive. \n";
-        return;
+        return SolveResult::Solved;
+    }
+    if (stats.limitReached)
+    {
+        clearAnswers();
+        return SolveResult::LimitReached;
     }
-    spacer = std::string(sp, ' ');
+    return SolveResult::Unsolvable;
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::setNumber(int rowIndex, int colIndex, int value)
+template <int BoxSize>
+PropagationSolver& BasicSudoku<BoxSize>::propagationSolver() const
 {
-    if ((value < NoValue) || (MaxValue < value) ||
-        (rowIndex < MinCoord) || (MaxCoord < rowIndex)  ||
-        (colIndex < MinCoord) || (MaxCoord < colIndex) ||
-        (getCellStatus(rowIndex, colIndex) == CellState::Fixed))
+    // Techniques only remove candidates no solution uses, so counts stay exact with them
+    PropagationSolver& solver = SolverContext::forThisThread().propagation;
+    solver.setTechniques((solverStrategy == SolverStrategy::Deduction) ? techniques : 0);
+    return solver;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+template <typename Stats>
+bool BasicSudoku<BoxSize>::solveWith(Stats& stats)
+{
+    clearAnswers();
+
+    if constexpr (BoxSize == 3)
+    {
+        switch (solverStrategy)
+        {
+            case SolverStrategy::Propagation:
+            case SolverStrategy::Deduction:
+                return propagationSolver().solve(*this, stats);
+
+            case SolverStrategy::DancingLinks:
+                return SolverContext::forThisThread().dlx.solve(*this, stats);
+
+            case SolverStrategy::Iterative:
+                return SolverContext::forThisThread().iterative.solve(*this, stats);
+
+            case SolverStrategy::DepthFirst:
+                break;
+        }
+    }
+
+    // The givens are audited once here; from then on the search only makes legal placements
+    if (!isValid())
     {
         return false;
     }
 
-    grid[rowIndex][colIndex].value = value;
-    return true;
+    if constexpr (BoxSize == 3)
+    {
+        if (displaySolver)
+        {
+            SolverDisplay display(*this);
+            solverDisplay = &display;
+            display.start();
+
+            const bool solved = solveRecursive(Coord(0, 0), stats, 0);
+
+            display.stop();
+            solverDisplay = nullptr;
+            return solved;
+        }
+    }
 
+    return solveRecursive(Coord(0, 0), stats, 0);
 }
 
 //------------------------------------------------------------------------------------------
 
-void Sudoku::clearAnswers()
+template <int BoxSize>
+int BasicSudoku<BoxSize>::countSolutions(int limit) const
 {
-    for (auto& row : grid)
+    BasicSudoku givens = *this;
+    givens.clearAnswers();
+
+    NoSolverStats stats;
+
+    if constexpr (BoxSize == 3)
+    {
+        return givens.propagationSolver().countSolutions(givens, limit, stats);
+    }
+    else
     {
-        for (auto& cell : row)
+        int count = 0;
+
+        if (givens.isValid())
         {
-            if (cell.state == CellState::ToFill)
-            {
-                cell.value = NoValue;
-            }
+            givens.countRecursive(Coord(0, 0), limit, count, stats, 0);
         }
+        return count;
     }
 }
 
 //------------------------------------------------------------------------------------------
 
-std::ostream& operator<<(std::ostream& os, Sudoku& sud)
+template <int BoxSize>
+int BasicSudoku<BoxSize>::countSolutions(int limit, SolverStats& stats) const
 {
-    std::string rowSeparator;
-    std::string rowBetweenCoordSudoku;
-    std::string rowOfNumbers;
+    // Answers entered so far are ignored, as in solve()
+    BasicSudoku givens = *this;
+    givens.clearAnswers();
 
-    rowSeparator = sud.formatRowSeparator('-');
-    rowBetweenCoordSudoku = sud.formatRowSeparator(sud.coordSudokuSeparator);
+    const auto start = std::chrono::steady_clock::now();
+    int count = 0;
 
-    os << sud.formatCoordRow() << "\n";
+    if constexpr (BoxSize == 3)
+    {
+        count = givens.propagationSolver().countSolutions(givens, limit, stats);
+    }
+    else if (givens.isValid())
+    {
+        givens.countRecursive(Coord(0, 0), limit, count, stats, 0);
+    }
+    stats.wallTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return count;
+}
 
-    // Displaying vertical spacer between coords and sudoku
-    for (int j = 0; j < sud.spacer.length(); ++j)
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+void BasicSudoku<BoxSize>::setSpacePadding(int sp)
+{
+    if ((sp < PaddingLowerLimit) || (PaddingUpperLimit < sp))
     {
-        os << sud.formatRowSeparator(' ') << "\n";
+        std::cout << "Space padding must be between " << PaddingLowerLimit << " and " << PaddingUpperLimit << ", inclusive. \n";
+        return;
     }
+    padding = sp;
+}
 
-    // Displaying sudoku
-    for (int i = 0; i < sud.SudokuWidth; ++i)
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::setNumber(int rowIndex, int colIndex, int value)
+{
+    if ((value < NoValue) || (MaxValue < value) ||
+        (rowIndex < MinCoord) || (MaxCoord < rowIndex)  ||
+        (colIndex < MinCoord) || (MaxCoord < colIndex) ||
+        (getCellStatus(rowIndex, colIndex) == CellState::Fixed))
     {
-        rowOfNumbers = sud.formatRow(i);
+        return false;
+    }
 
-        // Have a double separator for boxes
-        if ((i % sud.BoxWidth) == 0)
+    std::uint8_t& cell = values[cellIndex(rowIndex, colIndex)];
+
+    if (cell != NoValue)
+    {
+        removeFromMasks(rowIndex, colIndex, cell);
+    }
+    if (value != NoValue)
+    {
+        addToMasks(rowIndex, colIndex, value);
+    }
+
+    cell = static_cast<std::uint8_t>(value);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+typename BasicSudoku<BoxSize>::DigitMask BasicSudoku<BoxSize>::candidates(int rowIndex, int colIndex) const
+{
+    return static_cast<DigitMask>(~(rowMasks[rowIndex] | colMasks[colIndex] | boxMasks[boxIndex(rowIndex, colIndex)]) & AllDigits);
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::canPlace(int rowIndex, int colIndex, int value) const
+{
+    const DigitMask used = rowMasks[rowIndex] | colMasks[colIndex] | boxMasks[boxIndex(rowIndex, colIndex)];
+    return (used & digitBit(value)) == 0;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+void BasicSudoku<BoxSize>::clearAnswers()
+{
+    for (int index = 0; index < CellCount; ++index)
+    {
+        if (!fixedCells[index])
         {
-            os << rowSeparator << "\n";
+            values[index] = NoValue;
         }
-
-        os << rowOfNumbers << "\n" << rowSeparator << "\n";
     }
-    os << "\n";
+    rebuildMasks();
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+std::ostream& operator<<(std::ostream& os, const BasicSudoku<BoxSize>& sud)
+{
+    char buffer[BasicSudoku<BoxSize>::MaxRenderLength];
+    os.write(buffer, static_cast<std::streamsize>(sud.render(buffer)));
     return os;
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::Coord::nextCell()
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::Coord::nextCell()
 {
     if ((x == MaxCoord) && (y == MaxCoord))
     {
@@ -226,54 +664,156 @@ bool Sudoku::Coord::nextCell()
 
 //------------------------------------------------------------------------------------------
 
-std::string Sudoku::formatRow(int rowIndex) const
+template <int BoxSize>
+std::size_t BasicSudoku<BoxSize>::render(char* buffer, RenderStyle style) const
 {
-    std::ostringstream formattedRow;
+    const RenderTemplates& lines = renderTemplates(padding);
+    char* out = buffer;
+
+    const auto append = [&out](const std::string& line)
+    {
+        out = std::copy(line.begin(), line.end(), out);
+    };
+
+    append(lines.coordRow);
+
+    // Vertical spacer between coords and sudoku
+    for (int j = 0; j < padding; ++j)
+    {
+        append(lines.blankRow);
+    }
+
+    for (int i = 0; i < SudokuWidth; ++i)
+    {
+        // Have a double separator for boxes
+        if ((i % BoxWidth) == 0)
+        {
+            append(lines.separatorRow);
+        }
+
+        out = renderRow(i, out, style);
+        append(lines.separatorRow);
+    }
+    *out++ = '\n';
+
+    return static_cast<std::size_t>(out - buffer);
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+char* BasicSudoku<BoxSize>::renderRow(int rowIndex, char* out, RenderStyle style) const
+{
+    static constexpr std::string_view BoldCode = "\033[1m";
+    static constexpr std::string_view RedCode = "\033[31m";
+    static constexpr std::string_view GreenCode = "\033[32m";
+    static constexpr std::string_view ConflictCode = "\033[41m";
+    static constexpr std::string_view ResetCode = "\033[0m";
+
+    const auto append = [&out](std::string_view text)
+    {
+        out = std::copy(text.begin(), text.end(), out);
+    };
 
     // To display coords
-    formattedRow << rowIndex << spacer << coordSudokuSeparator;
+    out = writeNumber(out, rowIndex, coordWidth);
+    out = std::fill_n(out, padding, ' ');
+    *out++ = coordSudokuSeparator;
 
     for (int colIndex = 0; colIndex < SudokuWidth; ++colIndex)
     {
-        std::string colour;
-
         if ((colIndex % BoxWidth) == 0)
         {
             // Have a double separator for boxes
-            formattedRow << verticalLine;
+            *out++ = verticalLine;
         }
+        out = std::fill_n(out, padding, ' ');
 
-        if (getCellStatus(rowIndex, colIndex) == CellState::Fixed)
-        {
-            // Displaying starting digits as bold
-            colour = "\033[1m";
-        }
-        else if (getNumber(rowIndex, colIndex) == NoValue)
+        const int value = getNumber(rowIndex, colIndex);
+
+        if (style == RenderStyle::Colour)
         {
-            // Displaying 0's as red
-            colour = "\033[31m";
+            // Starting digits in bold, 0's in red and added digits in green, or on red when
+            // they clash with another copy in their row, column or box
+            if (getCellStatus(rowIndex, colIndex) == CellState::Fixed)
+            {
+                append(BoldCode);
+            }
+            else if (value == NoValue)
+            {
+                append(RedCode);
+            }
+            else
+            {
+                append(hasConflict(rowIndex, colIndex) ? ConflictCode : GreenCode);
+            }
         }
-        else
+
+        out = writeNumber(out, value, digitsPerCell);
+
+        if (style == RenderStyle::Colour)
         {
-            // Displaying added digits as green
-            colour = "\033[32m";
+            append(ResetCode);
         }
 
-        formattedRow << spacer << colour << getNumber(rowIndex, colIndex) << "\033[0m" << spacer << verticalLine;
+        out = std::fill_n(out, padding, ' ');
+        *out++ = verticalLine;
     }
-    return formattedRow.str();
+    *out++ = '\n';
+
+    return out;
 }
 
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+char* BasicSudoku<BoxSize>::writeNumber(char* out, int number, int width)
+{
+    char* const end = out + width;
+    char* digit = end;
+
+    do
+    {
+        *--digit = static_cast<char>('0' + number % 10);
+        number /= 10;
+    } while (number != 0);
+
+    std::fill(out, digit, ' ');
+    return end;
+}
 
 //------------------------------------------------------------------------------------------
 
-std::string Sudoku::formatRowSeparator(char repeat) const
+template <int BoxSize>
+const typename BasicSudoku<BoxSize>::RenderTemplates& BasicSudoku<BoxSize>::renderTemplates(int padding)
 {
-    const int width = (1 + digitsPerCell + (2 * spacer.size())) * SudokuWidth + (SudokuWidth / BoxWidth);
+    static const std::array<RenderTemplates, PaddingUpperLimit + 1> templates = []
+    {
+        std::array<RenderTemplates, PaddingUpperLimit + 1> built;
+
+        for (int pad = PaddingLowerLimit; pad <= PaddingUpperLimit; ++pad)
+        {
+            built[pad].coordRow = formatCoordRow(pad) + '\n';
+            built[pad].blankRow = formatRowSeparator(pad, ' ') + '\n';
+            built[pad].separatorRow = formatRowSeparator(pad, '-') + '\n';
+        }
+        return built;
+    }();
+
+    return templates[padding];
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+std::string BasicSudoku<BoxSize>::formatRowSeparator(int padding, char repeat)
+{
+    const int width = (1 + digitsPerCell + (2 * padding)) * SudokuWidth + (SudokuWidth / BoxWidth);
+    const std::string spacer(padding, ' ');
 
     std::ostringstream formattedRow;
 
-    formattedRow << " " << spacer << coordSudokuSeparator;
+    formattedRow << std::string(coordWidth, ' ') << spacer << coordSudokuSeparator;
 
     for (int i = 0; i < width; ++i)
     {
@@ -285,11 +825,13 @@ std::string Sudoku::formatRowSeparator(char repeat) const
 
 //------------------------------------------------------------------------------------------
 
-std::string Sudoku::formatCoordRow() const
+template <int BoxSize>
+std::string BasicSudoku<BoxSize>::formatCoordRow(int padding)
 {
     std::ostringstream formattedCoordRow;
+    const std::string spacer(padding, ' ');
 
-    formattedCoordRow << " " << spacer << coordSudokuSeparator;
+    formattedCoordRow << std::string(coordWidth, ' ') << spacer << coordSudokuSeparator;
 
     for (int colIndex = 0; colIndex < SudokuWidth; ++colIndex)
     {
@@ -298,7 +840,7 @@ std::string Sudoku::formatCoordRow() const
             // Have a double separator for boxes
             formattedCoordRow << ' ';
         }
-        formattedCoordRow << spacer << colIndex << spacer << ' ';
+        formattedCoordRow << spacer << std::setw(digitsPerCell) << colIndex << spacer << ' ';
     }
 
     return formattedCoordRow.str();
@@ -306,130 +848,217 @@ std::string Sudoku::formatCoordRow() const
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::isSequenceValid(const std::vector<int>& sequence) const
+template <int BoxSize>
+template <typename Stats>
+bool BasicSudoku<BoxSize>::solveRecursive(Coord currentCoord, Stats& stats, int depth)
 {
-    //TODO: add check to make sure sequence is 9 long
-    std::vector<int> checkedNums(SudokuWidth);
+    stats.enterNode(depth);
 
-    for (int i = 0; i < SudokuWidth; ++i)
+    if (stats.shouldStop())
     {
-        const int currentCell = sequence[i];
+        return false;
+    }
+
+    // Every placement on the way here was legal, so a full board is a solved one
+    if (!nextValidCell(currentCoord))
+    {
+        return true;
+    }
 
-        if ((currentCell != NoValue) && (checkedNums[currentCell - 1] == 1))
+    for (int cellValue = MinValue; cellValue <= MaxValue; ++cellValue)
+    {
+        if (!canPlace(currentCoord.y, currentCoord.x, cellValue))
         {
-            return false;
+            continue;
         }
-        else if (currentCell != NoValue)
+
+        setNumber(currentCoord, cellValue);
+        stats.guess();
+        stats.place();
+
+        if (solverDisplay)
         {
-            checkedNums[currentCell - 1]++;
+            solverDisplay->publish(cellIndex(currentCoord.y, currentCoord.x), cellValue);
         }
-    }
-    return true;
-}
 
-//------------------------------------------------------------------------------------------
+        if (solveRecursive(currentCoord, stats, depth + 1))
+        {
+            return true;
+        }
+        stats.backtrack();
 
-bool Sudoku::isRowValid(int rowIndex) const
-{
-    std::vector<int> sequence(SudokuWidth);
+        if (stats.shouldStop())
+        {
+            break;
+        }
+    }
 
-    for (int colIndex = 0; colIndex < SudokuWidth; ++colIndex)
+    setNumber(currentCoord, NoValue);
+
+    if (solverDisplay)
     {
-        sequence[colIndex] = getNumber(rowIndex, colIndex);
+        solverDisplay->publish(cellIndex(currentCoord.y, currentCoord.x), NoValue);
     }
-    return isSequenceValid(sequence);
+    return false;
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::isColumnValid(int colIndex) const
+template <int BoxSize>
+template <typename Stats>
+void BasicSudoku<BoxSize>::countRecursive(Coord currentCoord, int limit, int& count, Stats& stats, int depth)
 {
-    std::vector<int> sequence(SudokuWidth);
+    stats.enterNode(depth);
 
-    for (int rowIndex = 0; rowIndex < SudokuWidth; ++rowIndex)
+    if (!nextValidCell(currentCoord))
     {
-        sequence[rowIndex] = getNumber(rowIndex, colIndex);
+        ++count;
+        return;
     }
-    return isSequenceValid(sequence);
+
+    for (int cellValue = MinValue; (cellValue <= MaxValue) && (count < limit); ++cellValue)
+    {
+        if (canPlace(currentCoord.y, currentCoord.x, cellValue))
+        {
+            setNumber(currentCoord, cellValue);
+            stats.guess();
+            stats.place();
+            countRecursive(currentCoord, limit, count, stats, depth + 1);
+            stats.backtrack();
+        }
+    }
+    setNumber(currentCoord, NoValue);
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::isBoxValid(int rowIndex, int colIndex) const
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::nextValidCell(Coord& currentCell) const
 {
-    std::vector<int> sequence(SudokuWidth);
-
-    for (int cellsChecked = 0; cellsChecked < SudokuWidth; ++cellsChecked)
+    while (getNumber(currentCell) != NoValue)
     {
-        const int withinBoxColIndex = cellsChecked % BoxWidth;
-        const int withinBoxRowIndex = cellsChecked / BoxWidth;
-
-        sequence[cellsChecked] = getNumber(rowIndex + withinBoxRowIndex, colIndex + withinBoxColIndex);
+        if (currentCell.nextCell())
+        {
+            return false;
+        }
     }
-    return isSequenceValid(sequence);
+    return true;
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::solveRecursive(Coord currentCoord)
+template <int BoxSize>
+bool BasicSudoku<BoxSize>::setNumber(Coord coord, int value)
 {
-    currentCoord = nextValidCell(currentCoord);
-
-    for (int cellValue = MinValue; cellValue <= MaxValue; ++cellValue)
-    {
-        setNumber(currentCoord, cellValue);
-
-        if (displaySolver)
-        {
-            clearScreen();
-            std::cout << *this << "\n";
-        }
+    return setNumber(coord.y, coord.x, value);
+}
 
-        if (isDone() || (isValid() && solveRecursive(currentCoord)))
-        {
-            return true;
-        }
-    }
+//------------------------------------------------------------------------------------------
 
-    setNumber(currentCoord, NoValue);
-    return false;
+template <int BoxSize>
+int BasicSudoku<BoxSize>::getNumber(int rowIndex, int colIndex) const
+{
+    return values[cellIndex(rowIndex, colIndex)];
 }
 
 //------------------------------------------------------------------------------------------
 
-Sudoku::Coord Sudoku::nextValidCell(Coord currentCell) const
+template <int BoxSize>
+int BasicSudoku<BoxSize>::getNumber(Coord coord) const
 {
-    while (getNumber(currentCell) != NoValue)
-    {
-        currentCell.nextCell();
-    }
-    return currentCell;
+    return getNumber(coord.y, coord.x);
 }
 
 //------------------------------------------------------------------------------------------
 
-bool Sudoku::setNumber(Coord coord, int value)
+template <int BoxSize>
+typename BasicSudoku<BoxSize>::CellState BasicSudoku<BoxSize>::getCellStatus(int rowIndex, int colIndex) const
 {
-    return setNumber(coord.y, coord.x, value);
+    return fixedCells[cellIndex(rowIndex, colIndex)] ? CellState::Fixed : CellState::ToFill;
 }
 
 //------------------------------------------------------------------------------------------
 
-int Sudoku::getNumber(int rowIndex, int colIndex) const
+template <int BoxSize>
+void BasicSudoku<BoxSize>::addToMasks(int rowIndex, int colIndex, int value)
 {
-    return grid[rowIndex][colIndex].value;
+    const int boxIdx = boxIndex(rowIndex, colIndex);
+    const DigitMask bit = digitBit(value);
+    rowMasks[rowIndex] |= bit;
+    colMasks[colIndex] |= bit;
+    boxMasks[boxIdx] |= bit;
+
+    for (const int unit : {rowIndex, SudokuWidth + colIndex, 2 * SudokuWidth + boxIdx})
+    {
+        if (++unitCounts[unit][value] > 1)
+        {
+            ++conflictCount;
+        }
+    }
+    ++filledCount;
 }
 
 //------------------------------------------------------------------------------------------
 
-int Sudoku::getNumber(Coord coord) const
+template <int BoxSize>
+void BasicSudoku<BoxSize>::removeFromMasks(int rowIndex, int colIndex, int value)
 {
-    return getNumber(coord.y, coord.x);
+    const int boxIdx = boxIndex(rowIndex, colIndex);
+    const DigitMask bit = ~digitBit(value);
+
+    // The mask bit goes with the last copy of the digit; removing any other copy ends a conflict
+    const auto release = [&](int unit, DigitMask& mask)
+    {
+        if (--unitCounts[unit][value] == 0)
+        {
+            mask &= bit;
+        }
+        else
+        {
+            --conflictCount;
+        }
+    };
+
+    release(rowIndex, rowMasks[rowIndex]);
+    release(SudokuWidth + colIndex, colMasks[colIndex]);
+    release(2 * SudokuWidth + boxIdx, boxMasks[boxIdx]);
+    --filledCount;
 }
 
 //------------------------------------------------------------------------------------------
 
-Sudoku::CellState Sudoku::getCellStatus(int rowIndex, int colIndex) const
+template <int BoxSize>
+void BasicSudoku<BoxSize>::rebuildMasks()
 {
-    return grid[rowIndex][colIndex].state;
+    rowMasks.fill(0);
+    colMasks.fill(0);
+    boxMasks.fill(0);
+    unitCounts = {};
+    conflictCount = 0;
+    filledCount = 0;
+
+    for (int rowIndex = 0; rowIndex < SudokuWidth; ++rowIndex)
+    {
+        for (int colIndex = 0; colIndex < SudokuWidth; ++colIndex)
+        {
+            const int value = getNumber(rowIndex, colIndex);
+
+            if (value != NoValue)
+            {
+                addToMasks(rowIndex, colIndex, value);
+            }
+        }
+    }
 }
+
+//------------------------------------------------------------------------------------------
+
+template class BasicSudoku<2>;
+template class BasicSudoku<3>;
+template class BasicSudoku<4>;
+template class BasicSudoku<5>;
+
+template std::ostream& operator<<(std::ostream&, const BasicSudoku<2>&);
+template std::ostream& operator<<(std::ostream&, const BasicSudoku<3>&);
+template std::ostream& operator<<(std::ostream&, const BasicSudoku<4>&);
+template std::ostream& operator<<(std::ostream&, const BasicSudoku<5>&);
@@ -1,35 +1,183 @@
 #pragma once
 
+#include "solver_stats.hpp"
+#include "sudoku_units.hpp"
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
+class PropagationSolver;
+class SolverDisplay;
+
 //------------------------------------------------------------------------------------------
 
-class Sudoku
+// A board of BoxSize x BoxSize boxes, so BoxSize 3 is the classic 9x9 puzzle. The board is
+// stored flat, so the whole class is trivially copyable and for 9x9 the values plus
+// fixed-cell bits sit in the first two cache lines. Instantiated in sudoku.cpp for box sizes
+// 2 to 5; the propagation, Dancing Links and iterative solvers are 9x9 only, and the other
+// sizes always search depth-first.
+template <int BoxSize>
+class alignas(64) BasicSudoku
 {
 public:
-    Sudoku() : grid(SudokuWidth, std::vector<Cell>(SudokuWidth)) {}
+    static constexpr int BoxWidth = BoxSize;
+    static constexpr int SudokuWidth = BoxSize * BoxSize;
+    static constexpr int CellCount = SudokuWidth * SudokuWidth;
+    static constexpr int MaxValue = SudokuWidth;
+
+    enum class SolverStrategy
+    {
+        DepthFirst,
+        Propagation,
+        DancingLinks,
+        // Same search as DepthFirst, run from an explicit trail instead of recursion
+        Iterative,
+        // Propagation, with the deduction techniques tried whenever the singles are stuck
+        Deduction,
+    };
+
+    BasicSudoku() = default;
 
+    // Reads SudokuWidth rows of SudokuWidth delimited numbers, 0 for empty cells
     bool readFromCsv(std::ifstream &, char);
 
-    bool isValid() const;
-    bool isFull() const;
-    bool isDone() const;
+    // Reads the single-line format of one symbol per cell in row-major order, with '.' or '0'
+    // for empty cells. Values above 9 are written as letters from 'A', so 16x16 uses 1-9 and A-G.
+    bool readFromLine(std::string_view);
+    // Writes LineLength characters in the single-line format, with '.' for empty cells
+    void writeToLine(char*) const;
+
+    static constexpr int LineLength = CellCount;
+
+    // Replaces the board with LineLength row-major values, 0 for empty cells; the others become givens
+    void loadGivens(const std::uint8_t*);
+
+    // Packed records hold the row-major values in PackedBitsPerCell bits each, two cells to a
+    // byte (low nibble first) while the values fit in four bits, with 0 for empty cells
+    static constexpr int PackedBitsPerCell = (MaxValue < 16) ? 4 : 8;
+    static constexpr std::size_t PackedLength = (CellCount * PackedBitsPerCell + 7) / 8;
+
+    // Loads the givens straight from a packed record. If solution is also given, its values
+    // fill the other cells as answers. Returns false if a value is out of range.
+    bool loadPacked(const std::uint8_t* givens, const std::uint8_t* solution = nullptr);
+    // Writes the current values, answers included, as a PackedLength-byte record
+    void storePacked(std::uint8_t*) const;
+
+    // Row-major values, NoValue for empty cells
+    const std::uint8_t* cells() const { return values.data(); }
+    // Copies the answers from CellCount row-major values, leaving the givens as they are
+    void fillAnswers(const std::uint8_t* solution);
+
+    // Answered from counts kept up to date by setNumber, without scanning the board
+    bool isValid() const { return conflictCount == 0; }
+    bool isFull() const { return filledCount == CellCount; }
+    bool isDone() const { return isFull() && isValid(); }
+
+    // Returns true if the digit at [rowIndex, colIndex] appears again in its row, column or box
+    bool hasConflict(int rowIndex, int colIndex) const;
+
+    // An empty cell whose value follows from the candidates alone
+    struct Hint
+    {
+        enum class Reason
+        {
+            // The only digit its row, column and box leave for the cell
+            NakedSingle,
+            // The only cell left for the digit in one of its units
+            HiddenSingle,
+        };
+
+        int rowIndex = 0;
+        int colIndex = 0;
+        int value = 0;
+        Reason reason = Reason::NakedSingle;
+        // Unit of a hidden single: rows 0 to SudokuWidth - 1, then the columns, then the boxes
+        int unit = 0;
+    };
 
-    // Returns true if successfully solved sudoku
+    // Finds the first forced cell in row-major order, naked singles before hidden singles,
+    // without searching. There is none when the board has a conflict or needs a guess.
+    std::optional<Hint> findHint() const;
+
+    // Returns true if successfully solved sudoku; the overload taking stats also records the
+    // search effort, which the plain one compiles out
     bool solve();
+    bool solve(SolverStats&);
+
+    enum class SolveResult
+    {
+        Solved,
+        Unsolvable,
+        // The deadline or node budget ran out, or the solve was cancelled
+        LimitReached,
+    };
+
+    // Solves within limits. When they stop the search the board is left with its givens only,
+    // and stats hold the effort spent up to that point.
+    SolveResult solve(const SolveLimits&);
+    SolveResult solve(const SolveLimits&, SolverStats&);
+
+    // Counts the solutions of the givens up to limit, leaving the board untouched
+    int countSolutions(int limit) const;
+    int countSolutions(int limit, SolverStats&) const;
+    bool hasUniqueSolution() const { return countSolutions(2) == 1; }
 
+    void setSolverStrategy(SolverStrategy strategy) { solverStrategy = strategy; }
+    // Techniques the Deduction strategy may use; all of them by default
+    void setTechniques(TechniqueMask mask) { techniques = mask; }
     void setSolverDisplay(bool status) { displaySolver = status; }
     void setSpacePadding(int);
 
     // Returns true if successfully set number
     bool setNumber(int rowIndex, int colIndex, int value);
 
+    // Returns true if value is not already used in the row, column or box of [rowIndex, colIndex]
+    bool canPlace(int rowIndex, int colIndex, int value) const;
+
     void clearAnswers();
 
-    friend std::ostream& operator<<(std::ostream&, Sudoku&);
+    enum class RenderStyle
+    {
+        // Givens bold, entered digits green (red background if they clash) and empty cells red,
+        // using ANSI escape codes
+        Colour,
+        // The same layout without escape codes, for output that is not a terminal
+        Plain,
+    };
+
+private:
+    static constexpr int PaddingLowerLimit = 0;
+    static constexpr int PaddingUpperLimit = 2;
+    // Numbers are right-aligned to the width of the largest value or coordinate
+    static constexpr int digitsPerCell = (MaxValue < 10) ? 1 : 2;
+    static constexpr int coordWidth = (SudokuWidth - 1 < 10) ? 1 : 2;
+
+    // Widest line at the largest padding, newline included, and the most lines
+    static constexpr int LongestRenderLine = coordWidth + PaddingUpperLimit + 1
+                                             + (1 + digitsPerCell + 2 * PaddingUpperLimit) * SudokuWidth + BoxWidth + 1;
+    static constexpr int MostRenderLines = 1 + PaddingUpperLimit + 2 * SudokuWidth + BoxWidth + 1;
+
+public:
+    // Enough for the board at any padding and style, allowing nine bytes of escape codes
+    // around every number
+    static constexpr std::size_t MaxRenderLength = LongestRenderLine * MostRenderLines + CellCount * 9;
+
+    // Formats the board into buffer in one pass without allocating, returning the number of
+    // characters written; buffer must hold MaxRenderLength characters
+    std::size_t render(char* buffer, RenderStyle = RenderStyle::Colour) const;
+
+    friend class PropagationSolver;
+    friend class DlxSolver;
+    friend class IterativeSolver;
+    friend class SolverDisplay;
 
 private:
     enum class CellState
@@ -38,12 +186,6 @@ private:
         ToFill,
     };
 
-    struct Cell
-    {
-        int value = 0;
-        CellState state = CellState::ToFill;
-    };
-
     struct Coord
     {
         Coord(int xx, int yy) : x(xx), y(yy) {}
@@ -52,40 +194,103 @@ private:
         int y = 0;
     };
 
-    std::string formatRow(int rowIndex) const;
-    std::string formatRowSeparator(char) const;
-    std::string formatCoordRow() const;
+    // The lines of the board that depend only on the padding, newline included
+    struct RenderTemplates
+    {
+        std::string coordRow;
+        std::string blankRow;
+        std::string separatorRow;
+    };
+
+    // Built once per padding on first use
+    static const RenderTemplates& renderTemplates(int padding);
+
+    static std::string formatRowSeparator(int padding, char);
+    static std::string formatCoordRow(int padding);
+
+    // Writes one row of numbers with its coordinate and newline, returning the end of the output
+    char* renderRow(int rowIndex, char* out, RenderStyle) const;
+    // Writes number right-aligned in width characters, returning the end of the output
+    static char* writeNumber(char* out, int number, int width);
+
+    // Symbols of the single-line format; symbolValue returns -1 for anything else
+    static char valueSymbol(int value);
+    static int symbolValue(char symbol);
+
+    static int packedValue(const std::uint8_t* record, int index);
+
+    // Board-size independent versions of the 9x9 parser and solution counter
+    bool readCsvRows(std::ifstream&, char);
+    template <typename Stats>
+    void countRecursive(Coord, int limit, int& count, Stats&, int depth);
 
-    bool isSequenceValid(const std::vector<int>&) const;
-    bool isRowValid(int rowIndex) const;
-    bool isColumnValid(int colIndex) const;
-    // Checks box with top left coordinates [rowIndex, colIndex]
-    bool isBoxValid(int rowIndex, int colIndex) const;
-    bool solveRecursive(Coord);
+    // Stats is SolverStats or NoSolverStats
+    template <typename Stats>
+    bool solveWith(Stats&);
+    // The calling thread's propagation solver, with the techniques of this board's strategy
+    PropagationSolver& propagationSolver() const;
+    template <typename Stats>
+    bool solveRecursive(Coord, Stats&, int depth);
 
-    // Increments cell from left to right, returning true if at the end of the sudoku
-    Coord nextValidCell(Coord) const;
+    // Moves coord from left to right onto the next empty cell, returning false if there is none
+    bool nextValidCell(Coord&) const;
+
+    // Bit (value - 1) is set in a mask when value is used somewhere in that row, column or box
+    using DigitMask = BasicCandidateMask<BoxSize>;
+
+    static DigitMask digitBit(int value) { return static_cast<DigitMask>(1u << (value - 1)); }
+    static int boxIndex(int rowIndex, int colIndex) { return (rowIndex / BoxWidth) * BoxWidth + (colIndex / BoxWidth); }
+
+    // Keep the masks and counts below in step with a value entering or leaving a cell
+    void addToMasks(int rowIndex, int colIndex, int value);
+    void removeFromMasks(int rowIndex, int colIndex, int value);
+    void rebuildMasks();
+
+    // Digits still possible in an empty cell
+    DigitMask candidates(int rowIndex, int colIndex) const;
 
     bool setNumber(Coord, int value);
     int getNumber(int rowIndex, int ColIndex) const;
     int getNumber(Coord) const;
     CellState getCellStatus(int rowIndex, int ColIndex) const;
 
-    std::vector<std::vector<Cell>> grid;
+    static int cellIndex(int rowIndex, int colIndex) { return rowIndex * SudokuWidth + colIndex; }
 
-    bool displaySolver = false;
     static constexpr auto coordSudokuSeparator = ' ';
     static constexpr char verticalLine = '|';
-    std::string spacer = " ";
 
-    static constexpr int SudokuWidth = 9;
-    static constexpr int BoxWidth = 3;
-    static constexpr int PaddingLowerLimit = 0;
-    static constexpr int PaddingUpperLimit = 2;
-    static constexpr int digitsPerCell = 1;
     static constexpr int NoValue = 0;
     static constexpr int MinValue = 1;
-    static constexpr int MaxValue = 9;
     static constexpr int MinCoord = 0;
     static constexpr int MaxCoord = SudokuWidth - 1;
+
+    // Row-major cell values, NoValue for empty cells
+    std::array<std::uint8_t, CellCount> values{};
+    std::bitset<CellCount> fixedCells;
+
+    // Kept up to date by setNumber. A bit stays set while any copy of its digit is in the unit.
+    std::array<DigitMask, SudokuWidth> rowMasks{};
+    std::array<DigitMask, SudokuWidth> colMasks{};
+    std::array<DigitMask, SudokuWidth> boxMasks{};
+
+    static constexpr int UnitCount = 3 * SudokuWidth;
+    static constexpr DigitMask AllDigits = static_cast<DigitMask>((1ull << SudokuWidth) - 1);
+
+    // Copies of each digit in each unit (rows, then columns, then boxes); every copy past the
+    // first in a unit adds one to conflictCount
+    std::array<std::array<std::uint8_t, MaxValue + 1>, UnitCount> unitCounts{};
+    int conflictCount = 0;
+    int filledCount = 0;
+
+    int padding = 1;
+    bool displaySolver = false;
+    // Set while a depth-first solve is being watched
+    SolverDisplay* solverDisplay = nullptr;
+    SolverStrategy solverStrategy = SolverStrategy::DepthFirst;
+    TechniqueMask techniques = AllTechniques;
 };
+
+template <int BoxSize>
+std::ostream& operator<<(std::ostream&, const BasicSudoku<BoxSize>&);
+
+using Sudoku = BasicSudoku<3>;
@@ -0,0 +1,912 @@
+#include "sudoku_batch.hpp"
+
+#include "deduction_pipeline.hpp"
+#include "lane_solver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+//------------------------------------------------------------------------------------------
+
+int SudokuBatch::exec()
+{
+    std::ios::sync_with_stdio(false);
+
+    if ((task != Task::Generate) && !openInput())
+    {
+        return 1;
+    }
+
+    if ((task == Task::Solve) && (cacheCapacity > 0))
+    {
+        cache = std::make_unique<SolutionCache>(cacheCapacity);
+
+        if (!cachePath.empty() && std::ifstream(cachePath).good() && !cache->load(cachePath))
+        {
+            return 1;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // Ratings come from the techniques the deduction solver used
+    const Sudoku::SolverStrategy strategy = (task == Task::Rate) ? Sudoku::SolverStrategy::Deduction : solverStrategy;
+
+    for (int i = 0; i < threadCount; ++i)
+    {
+        workers.push_back(std::make_unique<Worker>());
+        workers.back()->sudoku.setSolverStrategy(strategy);
+        workers.back()->sudoku.setTechniques(techniques);
+        workers.back()->stats.recordDepthHistogram = showStats;
+    }
+    slowWorker.sudoku.setSolverStrategy(strategy);
+    slowWorker.sudoku.setTechniques(techniques);
+    slowWorker.stats.recordDepthHistogram = showStats;
+    doneChunks.resize(static_cast<std::size_t>(threadCount * ChunksPerThread));
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(&SudokuBatch::runWorker, this, i);
+    }
+    std::thread writer(&SudokuBatch::runWriter, this);
+    std::thread slowLane(&SudokuBatch::runSlowLane, this);
+
+    if (task == Task::Generate)
+    {
+        readGeneratedChunks();
+    }
+    else if (inputPath == "-")
+    {
+        readStreamChunks(std::cin);
+    }
+    else
+    {
+        readMappedChunks(mappedInput.view());
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(slowMutex);
+        workersDone = true;
+    }
+    slowAvailable.notify_one();
+    slowLane.join();
+    writer.join();
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const long long puzzleCount = puzzlesSolved + puzzlesFailed + puzzlesRejected;
+
+    if (task == Task::Generate)
+    {
+        std::cerr << "Generated " << puzzlesSolved << " puzzles. \n";
+    }
+    else if (task == Task::FilterUnique)
+    {
+        std::cerr << "Kept " << puzzlesSolved << " of " << puzzleCount << " puzzles with a unique solution. \n";
+    }
+    else if (task == Task::Rate)
+    {
+        std::cerr << "Rated " << puzzlesSolved << " of " << puzzleCount << " puzzles. \n";
+    }
+    else
+    {
+        std::cerr << "Solved " << puzzlesSolved << " of " << puzzleCount << " puzzles. \n";
+    }
+
+    if (laneSolving && (task == Task::Solve))
+    {
+        long long laneSolved = 0;
+
+        for (const auto& worker : workers)
+        {
+            laneSolved += worker->laneSolved;
+        }
+
+        const LaneSolver::Kernel kernel = LaneSolver::activeKernel();
+        std::cerr << laneSolved << " puzzles were finished by singles in SIMD lanes (" << LaneSolver::name(kernel) << ", "
+                  << LaneSolver::laneCount(kernel) << " lanes). \n";
+    }
+
+    if (puzzlesSlowed > 0)
+    {
+        std::cerr << puzzlesSlowed << " puzzles went over budget and were finished in the slow lane. \n";
+    }
+
+    if (cache)
+    {
+        std::cerr << "Solution cache: " << cache->hits() << " hits, " << cache->misses() << " misses, "
+                  << cache->size() << " solutions kept. \n";
+
+        if (!cachePath.empty() && !cache->save(cachePath))
+        {
+            return 1;
+        }
+    }
+
+    if (showStats && (task != Task::Generate))
+    {
+        printStats();
+    }
+    printThroughput(elapsed.count());
+
+    return (puzzlesFailed == 0) ? 0 : 1;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::setThreadCount(int count)
+{
+    threadCount = std::max(count, 1);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::setBudgets(std::chrono::milliseconds time, std::uint64_t nodes)
+{
+    timeBudget = time;
+    nodeBudget = nodes;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::setCache(std::size_t capacity, const std::string& path)
+{
+    cacheCapacity = capacity;
+    cachePath = path;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SudokuBatch::openInput()
+{
+    if (inputPath != "-")
+    {
+        if (!mappedInput.open(inputPath))
+        {
+            std::cerr << "Error opening file '" << inputPath << "'. \n";
+            return false;
+        }
+        inputFormat = PuzzleScanner::detectFormat(mappedInput.view());
+        return true;
+    }
+
+    // Hold back the lines up to the first puzzle line, which tells the formats apart
+    std::string line;
+    std::string prefix;
+
+    while (std::getline(std::cin, line))
+    {
+        stdinPrefix.push_back(line);
+        prefix += line + '\n';
+
+        if (!line.empty() && (line != "\r"))
+        {
+            break;
+        }
+    }
+    inputFormat = PuzzleScanner::detectFormat(prefix);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::setGeneratorOptions(long long count, Difficulty difficulty, std::uint64_t seed)
+{
+    generateCount = count;
+    generateDifficulty = difficulty;
+    generateSeed = seed;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::readMappedChunks(std::string_view input)
+{
+    std::size_t sequence = 0;
+    std::size_t position = 0;
+    long long lineNumber = 1;
+    long long nonBlankLines = 0;
+
+    while (position < input.size())
+    {
+        ChunkPtr chunk = acquireChunk();
+        chunk->sequence = sequence++;
+        chunk->firstOffset = position;
+        chunk->firstLine = lineNumber;
+
+        std::size_t end = position;
+        int chunkLines = 0;
+
+        while ((end < input.size()) && ((chunkLines < ChunkLines) || !isPuzzleBoundary(nonBlankLines)))
+        {
+            const void* newline = std::memchr(input.data() + end, '\n', input.size() - end);
+            const std::size_t next = newline ? static_cast<std::size_t>(static_cast<const char*>(newline) - input.data()) + 1
+                                             : input.size();
+
+            const std::size_t contentLength = next - end - (newline ? 1 : 0);
+            const bool blank = (contentLength == 0) || ((contentLength == 1) && (input[end] == '\r'));
+
+            if (!blank)
+            {
+                ++nonBlankLines;
+            }
+
+            ++chunkLines;
+            ++lineNumber;
+            end = next;
+        }
+
+        chunk->input = input.substr(position, end - position);
+        position = end;
+        submitChunk(std::move(chunk));
+    }
+
+    finishReading(sequence);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::readStreamChunks(std::istream& input)
+{
+    std::string line;
+    std::size_t sequence = 0;
+    std::size_t offset = 0;
+    long long lineNumber = 1;
+    long long nonBlankLines = 0;
+
+    ChunkPtr chunk;
+    int chunkLines = 0;
+
+    auto appendLine = [&](const std::string& text)
+    {
+        if (!chunk)
+        {
+            chunk = acquireChunk();
+            chunk->sequence = sequence++;
+            chunk->firstOffset = offset;
+            chunk->firstLine = lineNumber;
+            chunkLines = 0;
+        }
+
+        chunk->buffer += text;
+        chunk->buffer += '\n';
+        offset += text.size() + 1;
+        ++lineNumber;
+
+        if (!text.empty() && (text != "\r"))
+        {
+            ++nonBlankLines;
+        }
+
+        if ((++chunkLines >= ChunkLines) && isPuzzleBoundary(nonBlankLines))
+        {
+            chunk->input = chunk->buffer;
+            submitChunk(std::move(chunk));
+        }
+    };
+
+    for (const std::string& heldLine : stdinPrefix)
+    {
+        appendLine(heldLine);
+    }
+
+    while (std::getline(input, line))
+    {
+        appendLine(line);
+    }
+
+    if (chunk)
+    {
+        chunk->input = chunk->buffer;
+        submitChunk(std::move(chunk));
+    }
+
+    finishReading(sequence);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::readGeneratedChunks()
+{
+    std::size_t sequence = 0;
+
+    for (long long first = 0; first < generateCount; first += ChunkPuzzles)
+    {
+        ChunkPtr chunk = acquireChunk();
+        chunk->sequence = sequence++;
+        chunk->firstPuzzle = first;
+        chunk->puzzleCount = static_cast<int>(std::min<long long>(ChunkPuzzles, generateCount - first));
+        submitChunk(std::move(chunk));
+    }
+
+    finishReading(sequence);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::finishReading(std::size_t chunkCount)
+{
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        readingDone = true;
+    }
+    workAvailable.notify_all();
+
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        totalChunks = chunkCount;
+        readerFinished = true;
+    }
+    chunkDone.notify_one();
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SudokuBatch::isPuzzleBoundary(long long nonBlankLines) const
+{
+    constexpr int CsvRowsPerPuzzle = 9;
+    return (inputFormat == PuzzleFormat::Line) || ((nonBlankLines % CsvRowsPerPuzzle) == 0);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::runWorker(int index)
+{
+    Worker& worker = *workers[index];
+    ChunkPtr chunk;
+
+    while (true)
+    {
+        if (takeChunk(index, chunk))
+        {
+            const auto start = std::chrono::steady_clock::now();
+            solveChunk(worker, *chunk);
+            const std::chrono::duration<double> busy = std::chrono::steady_clock::now() - start;
+
+            worker.busySeconds += busy.count();
+
+            if (chunk->slowPuzzles.empty())
+            {
+                finishChunk(std::move(chunk));
+            }
+            else
+            {
+                submitSlowChunk(std::move(chunk));
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(workMutex);
+        workAvailable.wait(lock, [this] { return (queuedChunks > 0) || readingDone; });
+
+        if ((queuedChunks == 0) && readingDone)
+        {
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::runWriter()
+{
+    std::size_t nextSequence = 0;
+
+    while (true)
+    {
+        ChunkPtr chunk;
+        {
+            std::unique_lock<std::mutex> lock(doneMutex);
+            ChunkPtr& slot = doneChunks[nextSequence % doneChunks.size()];
+            chunkDone.wait(lock, [this, &slot, nextSequence]
+            {
+                return slot || (readerFinished && (nextSequence == totalChunks));
+            });
+
+            if (!slot)
+            {
+                break;
+            }
+            chunk = std::move(slot);
+        }
+
+        std::cout.write(chunk->output.data(), static_cast<std::streamsize>(chunk->output.size()));
+        std::cerr << chunk->errors;
+
+        puzzlesSolved += chunk->solved;
+        puzzlesFailed += chunk->failed;
+        puzzlesRejected += chunk->rejected;
+        puzzlesSlowed += static_cast<long long>(chunk->slowPuzzles.size());
+
+        ++nextSequence;
+        releaseChunk(std::move(chunk));
+    }
+
+    std::cout.flush();
+}
+
+//------------------------------------------------------------------------------------------
+
+SudokuBatch::ChunkPtr SudokuBatch::acquireChunk()
+{
+    std::unique_lock<std::mutex> lock(freeMutex);
+
+    if (freeChunks.empty() && (chunksCreated < threadCount * ChunksPerThread))
+    {
+        ++chunksCreated;
+        return std::make_unique<Chunk>();
+    }
+
+    chunkFreed.wait(lock, [this] { return !freeChunks.empty(); });
+
+    ChunkPtr chunk = std::move(freeChunks.back());
+    freeChunks.pop_back();
+    return chunk;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::releaseChunk(ChunkPtr chunk)
+{
+    // Keep the buffers' capacity so later chunks reuse them
+    chunk->input = {};
+    chunk->buffer.clear();
+    chunk->output.clear();
+    chunk->errors.clear();
+    chunk->solved = 0;
+    chunk->failed = 0;
+    chunk->rejected = 0;
+    chunk->firstPuzzle = 0;
+    chunk->puzzleCount = 0;
+    chunk->slowPuzzles.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(freeMutex);
+        freeChunks.push_back(std::move(chunk));
+    }
+    chunkFreed.notify_one();
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::submitChunk(ChunkPtr chunk)
+{
+    const std::size_t workerIndex = chunk->sequence % workers.size();
+    workers[workerIndex]->queue.push(std::move(chunk));
+
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        ++queuedChunks;
+    }
+    workAvailable.notify_one();
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SudokuBatch::takeChunk(int index, ChunkPtr& chunk)
+{
+    bool taken = workers[index]->queue.pop(chunk);
+
+    for (std::size_t offset = 1; !taken && (offset < workers.size()); ++offset)
+    {
+        taken = workers[(index + offset) % workers.size()]->queue.steal(chunk);
+    }
+
+    if (taken)
+    {
+        std::lock_guard<std::mutex> lock(workMutex);
+        --queuedChunks;
+    }
+    return taken;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::finishChunk(ChunkPtr chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        const std::size_t slot = chunk->sequence % doneChunks.size();
+        doneChunks[slot] = std::move(chunk);
+    }
+    chunkDone.notify_one();
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::submitSlowChunk(ChunkPtr chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(slowMutex);
+        slowChunks.push_back(std::move(chunk));
+    }
+    slowAvailable.notify_one();
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::runSlowLane()
+{
+    while (true)
+    {
+        ChunkPtr chunk;
+        {
+            std::unique_lock<std::mutex> lock(slowMutex);
+            slowAvailable.wait(lock, [this] { return !slowChunks.empty() || workersDone; });
+
+            if (slowChunks.empty())
+            {
+                return;
+            }
+
+            chunk = std::move(slowChunks.front());
+            slowChunks.pop_front();
+        }
+
+        for (const SlowPuzzle& slowPuzzle : chunk->slowPuzzles)
+        {
+            solveSlowPuzzle(*chunk, slowPuzzle);
+        }
+        finishChunk(std::move(chunk));
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::solveChunk(Worker& worker, Chunk& chunk)
+{
+    if (task == Task::Generate)
+    {
+        worker.puzzles += chunk.puzzleCount;
+        generateChunk(worker, chunk);
+        return;
+    }
+
+    if ((task == Task::Solve) && laneSolving)
+    {
+        solveChunkInLanes(worker, chunk);
+        return;
+    }
+
+    PuzzleScanner scanner(chunk.input, inputFormat, ',', chunk.firstOffset, chunk.firstLine);
+
+    while (true)
+    {
+        switch (scanner.next(worker.sudoku))
+        {
+            case PuzzleScanner::Result::End:
+                return;
+
+            case PuzzleScanner::Result::Error:
+                ++worker.puzzles;
+                reportParseError(chunk, scanner);
+                break;
+
+            case PuzzleScanner::Result::Puzzle:
+                ++worker.puzzles;
+
+                if (task == Task::FilterUnique)
+                {
+                    filterPuzzle(worker, chunk);
+                }
+                else if (task == Task::Rate)
+                {
+                    ratePuzzle(worker, chunk, scanner);
+                }
+                else
+                {
+                    solvePuzzle(worker, chunk, scanner);
+                }
+                break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::solveChunkInLanes(Worker& worker, Chunk& chunk)
+{
+    // The chunk is read twice: once to hand all its puzzles to the lanes, then again to write
+    // them out in order, passing the ones the lanes could not finish to solvePuzzle
+    PuzzleScanner gather(chunk.input, inputFormat, ',', chunk.firstOffset, chunk.firstLine);
+    worker.laneBoards.clear();
+
+    for (auto result = gather.next(worker.sudoku); result != PuzzleScanner::Result::End; result = gather.next(worker.sudoku))
+    {
+        if (result == PuzzleScanner::Result::Puzzle)
+        {
+            worker.laneBoards.push_back(worker.sudoku);
+        }
+    }
+
+    LaneSolver::propagate(worker.laneBoards.data(), worker.laneBoards.size());
+
+    PuzzleScanner scanner(chunk.input, inputFormat, ',', chunk.firstOffset, chunk.firstLine);
+    std::size_t board = 0;
+
+    while (true)
+    {
+        switch (scanner.next(worker.sudoku))
+        {
+            case PuzzleScanner::Result::End:
+                return;
+
+            case PuzzleScanner::Result::Error:
+                ++worker.puzzles;
+                reportParseError(chunk, scanner);
+                break;
+
+            case PuzzleScanner::Result::Puzzle:
+            {
+                ++worker.puzzles;
+                const Sudoku& laneBoard = worker.laneBoards[board++];
+
+                if (!laneBoard.isDone())
+                {
+                    solvePuzzle(worker, chunk, scanner);
+                    break;
+                }
+
+                ++worker.laneSolved;
+                ++chunk.solved;
+
+                const std::size_t offset = chunk.output.size();
+                chunk.output.resize(offset + Sudoku::LineLength);
+                laneBoard.writeToLine(&chunk.output[offset]);
+                chunk.output += '\n';
+                break;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::solvePuzzle(Worker& worker, Chunk& chunk, const PuzzleScanner& scanner)
+{
+    Sudoku& sudoku = worker.sudoku;
+    bool solved = false;
+    CanonicalForm form;
+
+    // A puzzle equivalent to one solved before skips the solver
+    if (cache)
+    {
+        form = worker.canonicaliser.canonicalise(sudoku.cells());
+        solved = cache->lookup(form, sudoku);
+    }
+
+    if (!solved)
+    {
+        if ((timeBudget.count() > 0) || (nodeBudget > 0))
+        {
+            if (!solveWithinBudget(worker, chunk, scanner, solved))
+            {
+                return;
+            }
+        }
+        else
+        {
+            solved = showStats ? sudoku.solve(worker.stats) : sudoku.solve();
+        }
+
+        // Only a unique solution answers every puzzle equivalent to this one
+        if (solved && cache && sudoku.hasUniqueSolution())
+        {
+            cache->insert(form, sudoku);
+        }
+    }
+
+    if (solved)
+    {
+        ++chunk.solved;
+    }
+    else
+    {
+        chunk.errors += "Byte " + std::to_string(scanner.recordOffset()) + " (line " + std::to_string(scanner.recordLine())
+                        + "): puzzle has no solution. \n";
+        ++chunk.failed;
+    }
+
+    const std::size_t offset = chunk.output.size();
+    chunk.output.resize(offset + Sudoku::LineLength);
+    sudoku.writeToLine(&chunk.output[offset]);
+    chunk.output += '\n';
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SudokuBatch::solveWithinBudget(Worker& worker, Chunk& chunk, const PuzzleScanner& scanner, bool& solved)
+{
+    SolveLimits limits;
+    limits.maxNodes = nodeBudget;
+
+    if (timeBudget.count() > 0)
+    {
+        limits.deadline = std::chrono::steady_clock::now() + timeBudget;
+    }
+
+    const Sudoku::SolveResult result = worker.sudoku.solve(limits, worker.stats);
+
+    if (result != Sudoku::SolveResult::LimitReached)
+    {
+        solved = (result == Sudoku::SolveResult::Solved);
+        return true;
+    }
+
+    chunk.slowPuzzles.push_back(SlowPuzzle{ chunk.output.size(), scanner.recordOffset(), scanner.recordLine(), worker.sudoku });
+    chunk.output.append(Sudoku::LineLength, '.');
+    chunk.output += '\n';
+    return false;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::solveSlowPuzzle(Chunk& chunk, const SlowPuzzle& slowPuzzle)
+{
+    Sudoku& sudoku = slowWorker.sudoku;
+    sudoku = slowPuzzle.puzzle;
+
+    if (showStats ? sudoku.solve(slowWorker.stats) : sudoku.solve())
+    {
+        ++chunk.solved;
+
+        if (cache && sudoku.hasUniqueSolution())
+        {
+            cache->insert(slowWorker.canonicaliser.canonicalise(slowPuzzle.puzzle.cells()), sudoku);
+        }
+    }
+    else
+    {
+        chunk.errors += "Byte " + std::to_string(slowPuzzle.recordOffset) + " (line " + std::to_string(slowPuzzle.recordLine)
+                        + "): puzzle has no solution. \n";
+        ++chunk.failed;
+    }
+
+    sudoku.writeToLine(&chunk.output[slowPuzzle.outputOffset]);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::filterPuzzle(Worker& worker, Chunk& chunk)
+{
+    const int solutions = showStats ? worker.sudoku.countSolutions(2, worker.stats) : worker.sudoku.countSolutions(2);
+
+    if (solutions != 1)
+    {
+        ++chunk.rejected;
+        return;
+    }
+
+    const std::size_t offset = chunk.output.size();
+    chunk.output.resize(offset + Sudoku::LineLength);
+    worker.sudoku.writeToLine(&chunk.output[offset]);
+    chunk.output += '\n';
+    ++chunk.solved;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::ratePuzzle(Worker& worker, Chunk& chunk, const PuzzleScanner& scanner)
+{
+    const std::size_t offset = chunk.output.size();
+    chunk.output.resize(offset + Sudoku::LineLength);
+    worker.sudoku.writeToLine(&chunk.output[offset]);
+
+    // The rating needs the stats of this puzzle alone
+    SolverStats stats;
+
+    if (worker.sudoku.solve(stats))
+    {
+        chunk.output += ' ';
+        chunk.output += DeductionPipeline::rating(stats);
+        ++chunk.solved;
+    }
+    else
+    {
+        chunk.output += " unsolvable";
+        chunk.errors += "Byte " + std::to_string(scanner.recordOffset()) + " (line " + std::to_string(scanner.recordLine())
+                        + "): puzzle has no solution. \n";
+        ++chunk.failed;
+    }
+    chunk.output += '\n';
+
+    if (showStats)
+    {
+        worker.stats += stats;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::generateChunk(Worker& worker, Chunk& chunk)
+{
+    for (long long index = chunk.firstPuzzle; index < chunk.firstPuzzle + chunk.puzzleCount; ++index)
+    {
+        worker.generator.reseed(SudokuGenerator::puzzleSeed(generateSeed, static_cast<std::uint64_t>(index)));
+        const Sudoku puzzle = worker.generator.generate(generateDifficulty);
+
+        const std::size_t offset = chunk.output.size();
+        chunk.output.resize(offset + Sudoku::LineLength);
+        puzzle.writeToLine(&chunk.output[offset]);
+        chunk.output += '\n';
+        ++chunk.solved;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::reportParseError(Chunk& chunk, const PuzzleScanner& scanner)
+{
+    const ParseError& error = scanner.error();
+
+    chunk.errors += "Byte " + std::to_string(error.offset) + " (line " + std::to_string(error.line) + "): "
+                    + error.message + ". \n";
+
+    ++chunk.failed;
+
+    if (task == Task::FilterUnique)
+    {
+        return;
+    }
+
+    // Line records are echoed as they were; a broken CSV board becomes an empty line-format board
+    if (inputFormat == PuzzleFormat::Line)
+    {
+        chunk.output += scanner.record();
+    }
+    else
+    {
+        chunk.output.append(Sudoku::LineLength, '.');
+    }
+    chunk.output += '\n';
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::printThroughput(double elapsedSeconds) const
+{
+    long long totalPuzzles = 0;
+
+    for (std::size_t i = 0; i < workers.size(); ++i)
+    {
+        const Worker& worker = *workers[i];
+        const double rate = (worker.busySeconds > 0.0) ? (worker.puzzles / worker.busySeconds) : 0.0;
+
+        std::cerr << "Thread " << i << ": " << worker.puzzles << " puzzles, "
+                  << std::fixed << std::setprecision(0) << rate << " puzzles/s \n";
+        totalPuzzles += worker.puzzles;
+    }
+
+    const double totalRate = (elapsedSeconds > 0.0) ? (totalPuzzles / elapsedSeconds) : 0.0;
+    std::cerr << "Total: " << totalPuzzles << " puzzles in " << std::setprecision(3) << elapsedSeconds << " s, "
+              << std::setprecision(0) << totalRate << " puzzles/s \n";
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuBatch::printStats() const
+{
+    SolverStats total;
+    total.recordDepthHistogram = true;
+
+    for (const auto& worker : workers)
+    {
+        total += worker->stats;
+    }
+    total += slowWorker.stats;
+
+    std::cerr << "Solver statistics over all puzzles: \n" << total;
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "puzzle_scanner.hpp"
+#include "solution_cache.hpp"
+#include "sudoku.hpp"
+#include "sudoku_canonical.hpp"
+#include "sudoku_generator.hpp"
+#include "work_stealing_queue.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//------------------------------------------------------------------------------------------
+
+// Non-interactive solver for files of puzzles, either in the single-line format or as
+// 9-row CSV boards (detected from the first line). Writes one line per puzzle to stdout in
+// input order, with no prompts, screen clearing or colour codes. Puzzles that cannot be
+// read or solved are echoed and reported on stderr with their byte offset. As a filter,
+// only the puzzles with a unique solution are written, in the single-line format. As a
+// generator, no input is read and fresh puzzles are written instead. Rating writes each
+// puzzle followed by the dearest technique the deduction solver needed, or "guessing".
+//
+// The reader (the calling thread) cuts the input into chunks of lines and deals them out
+// to the workers' queues; idle workers steal from the others. Each worker owns its Sudoku,
+// and a writer thread emits finished chunks strictly in sequence order. Files are memory
+// mapped and chunks point straight into the mapping; only stdin is copied into chunks.
+
+class SudokuBatch
+{
+public:
+    enum class Task
+    {
+        // Write the solution of every puzzle
+        Solve,
+        // Write only the puzzles that have exactly one solution
+        FilterUnique,
+        // Write newly generated puzzles
+        Generate,
+        // Write every puzzle followed by the dearest step the deduction solver needed for it
+        Rate,
+    };
+
+    int exec();
+
+    void setTask(Task batchTask) { task = batchTask; }
+    void setInputPath(const std::string& path) { inputPath = path; }
+    void setSolverStrategy(Sudoku::SolverStrategy strategy) { solverStrategy = strategy; }
+    // Techniques of the deduction solver, which Rate always uses
+    void setTechniques(TechniqueMask mask) { techniques = mask; }
+    void setThreadCount(int count);
+    // Prints solver statistics summed over every puzzle at the end of the run
+    void setShowStats(bool status) { showStats = status; }
+    // Puzzles that outrun either budget are set aside and finished by a separate slow-lane
+    // thread, so they do not hold up the workers; 0 turns a budget off
+    void setBudgets(std::chrono::milliseconds time, std::uint64_t nodes);
+    // Reuses the solutions of puzzles seen before, in any orientation or relabelling, keeping
+    // up to capacity of them; 0 turns the cache off. With a path, the cache is loaded from
+    // it first if it exists and saved back at the end.
+    void setCache(std::size_t capacity, const std::string& path);
+    // Finishes the puzzles that singles alone can solve many at a time in SIMD lanes, before
+    // the solver sees them; the rest are solved as usual. The output is the same either way.
+    void setLaneSolving(bool status) { laneSolving = status; }
+
+    void setGeneratorOptions(long long count, Difficulty difficulty, std::uint64_t seed);
+
+private:
+    // A puzzle that went over budget, with the place its line was reserved in the output
+    struct SlowPuzzle
+    {
+        std::size_t outputOffset = 0;
+        std::size_t recordOffset = 0;
+        long long recordLine = 0;
+        Sudoku puzzle;
+    };
+
+    // A run of consecutive input lines, solved by one worker and written out as a whole
+    struct Chunk
+    {
+        std::size_t sequence = 0;
+        std::size_t firstOffset = 0;
+        long long firstLine = 0;
+        // Lines to solve, viewing either the mapped file or buffer
+        std::string_view input;
+        std::string buffer;
+        std::string output;
+        std::string errors;
+        // Puzzles solved, or kept when filtering
+        long long solved = 0;
+        // Puzzles that could not be read or solved
+        long long failed = 0;
+        // Puzzles dropped by the filter
+        long long rejected = 0;
+        // Range of puzzle numbers to generate
+        long long firstPuzzle = 0;
+        int puzzleCount = 0;
+        // Left for the slow lane, which finishes the chunk once they are solved
+        std::vector<SlowPuzzle> slowPuzzles;
+    };
+
+    using ChunkPtr = std::unique_ptr<Chunk>;
+
+    struct Worker
+    {
+        WorkStealingQueue<ChunkPtr> queue;
+        Sudoku sudoku;
+        SolverStats stats;
+        SudokuCanonicaliser canonicaliser;
+        // Reseeded for each puzzle it generates
+        SudokuGenerator generator{0};
+        // Puzzles of the current chunk, for the lanes
+        std::vector<Sudoku> laneBoards;
+        long long laneSolved = 0;
+        long long puzzles = 0;
+        double busySeconds = 0.0;
+    };
+
+    // Returns false if the input file cannot be opened
+    bool openInput();
+
+    void readMappedChunks(std::string_view);
+    void readStreamChunks(std::istream&);
+    void readGeneratedChunks();
+    void finishReading(std::size_t chunkCount);
+
+    // Chunks may only end where a puzzle ends
+    bool isPuzzleBoundary(long long nonBlankLines) const;
+    void runWorker(int index);
+    void runWriter();
+    void runSlowLane();
+
+    // Blocks until a chunk is free, which bounds the number of chunks in flight
+    ChunkPtr acquireChunk();
+    void releaseChunk(ChunkPtr);
+
+    void submitChunk(ChunkPtr);
+    bool takeChunk(int index, ChunkPtr&);
+    void finishChunk(ChunkPtr);
+    void submitSlowChunk(ChunkPtr);
+
+    void solveChunk(Worker&, Chunk&);
+    void solveChunkInLanes(Worker&, Chunk&);
+    // Appends the solved line, or the puzzle itself on failure, to the chunk output
+    void solvePuzzle(Worker&, Chunk&, const PuzzleScanner&);
+    // Appends the puzzle to the chunk output if it has a unique solution
+    void filterPuzzle(Worker&, Chunk&);
+    // Appends the puzzle and its rating to the chunk output
+    void ratePuzzle(Worker&, Chunk&, const PuzzleScanner&);
+    void generateChunk(Worker&, Chunk&);
+    // Returns true if the puzzle was solved or proven unsolvable within the budgets, otherwise
+    // reserves its output line and queues it for the slow lane
+    bool solveWithinBudget(Worker&, Chunk&, const PuzzleScanner&, bool& solved);
+    void solveSlowPuzzle(Chunk&, const SlowPuzzle&);
+    void reportParseError(Chunk&, const PuzzleScanner&);
+
+    void printThroughput(double elapsedSeconds) const;
+    void printStats() const;
+
+    Task task = Task::Solve;
+    std::string inputPath = "-";
+    Sudoku::SolverStrategy solverStrategy = Sudoku::SolverStrategy::Propagation;
+    TechniqueMask techniques = AllTechniques;
+    int threadCount = 1;
+    bool showStats = false;
+
+    std::chrono::milliseconds timeBudget{0};
+    std::uint64_t nodeBudget = 0;
+
+    std::size_t cacheCapacity = 0;
+    std::string cachePath;
+    std::unique_ptr<SolutionCache> cache;
+
+    bool laneSolving = false;
+
+    long long generateCount = 0;
+    Difficulty generateDifficulty = Difficulty::Medium;
+    std::uint64_t generateSeed = 0;
+
+    MappedFile mappedInput;
+    // Lines of stdin read ahead to detect the format
+    std::vector<std::string> stdinPrefix;
+    PuzzleFormat inputFormat = PuzzleFormat::Line;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    Worker slowWorker;
+
+    std::mutex slowMutex;
+    std::condition_variable slowAvailable;
+    std::deque<ChunkPtr> slowChunks;
+    bool workersDone = false;
+
+    std::mutex workMutex;
+    std::condition_variable workAvailable;
+    int queuedChunks = 0;
+    bool readingDone = false;
+
+    std::mutex freeMutex;
+    std::condition_variable chunkFreed;
+    std::vector<ChunkPtr> freeChunks;
+    int chunksCreated = 0;
+
+    std::mutex doneMutex;
+    std::condition_variable chunkDone;
+    // Finished chunks waiting for the writer, in slot sequence % size. Every chunk in flight
+    // is within ChunksPerThread * threadCount of the next to be written, so slots never clash.
+    std::vector<ChunkPtr> doneChunks;
+    std::size_t totalChunks = 0;
+    bool readerFinished = false;
+
+    // Only touched by the writer thread
+    long long puzzlesSolved = 0;
+    long long puzzlesFailed = 0;
+    long long puzzlesRejected = 0;
+    long long puzzlesSlowed = 0;
+
+    static constexpr int ChunkLines = 1024;
+    static constexpr int ChunkPuzzles = 64;
+    static constexpr int ChunksPerThread = 4;
+};
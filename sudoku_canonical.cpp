@@ -0,0 +1,298 @@
+#include "sudoku_canonical.hpp"
+
+#include <algorithm>
+#include <functional>
+
+//------------------------------------------------------------------------------------------
+
+void SudokuTransform::apply(const std::uint8_t* cells, std::uint8_t* out) const
+{
+    for (int row = 0; row < Width; ++row)
+    {
+        for (int col = 0; col < Width; ++col)
+        {
+            out[row * Width + col] = digits[cells[sourceCell(row, col)]];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuTransform::invert(const std::uint8_t* cells, std::uint8_t* out) const
+{
+    std::array<std::uint8_t, Width + 1> inverse{};
+
+    for (int digit = 0; digit <= Width; ++digit)
+    {
+        inverse[digits[digit]] = static_cast<std::uint8_t>(digit);
+    }
+
+    for (int row = 0; row < Width; ++row)
+    {
+        for (int col = 0; col < Width; ++col)
+        {
+            out[sourceCell(row, col)] = inverse[cells[row * Width + col]];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+CanonicalForm SudokuCanonicaliser::canonicalise(const std::uint8_t* cells)
+{
+    haveBest = false;
+
+    // The transpose swaps the row and column counts, so only the orientation with the
+    // fuller rows can hold the smallest key, unless both are alike
+    std::array<std::uint8_t, Width> orientationTargets[2];
+
+    for (const bool transposed : {false, true})
+    {
+        for (int cell = 0; cell < CellCount; ++cell)
+        {
+            const int row = SudokuUnits::rowOf(cell);
+            const int col = SudokuUnits::colOf(cell);
+            grid[cell] = transposed ? cells[col * Width + row] : cells[cell];
+        }
+
+        planCounts();
+        orientationTargets[transposed] = rowTarget;
+
+        if (transposed && (orientationTargets[1] < orientationTargets[0]))
+        {
+            break;
+        }
+        if (!transposed && (rowTarget < colTarget))
+        {
+            continue;
+        }
+
+        current.transposed = transposed;
+        labels = Labels{};
+        usedRows = 0;
+        usedCols = 0;
+        search(0, !haveBest);
+    }
+
+    // Digits missing from the board take the labels left over, in order, so solutions map
+    // into the canonical frame as well
+    CanonicalForm form;
+    form.transform = bestTransform;
+    std::uint8_t next = 1;
+
+    for (int digit = 1; digit <= Width; ++digit)
+    {
+        next = std::max<std::uint8_t>(next, static_cast<std::uint8_t>(form.transform.digits[digit] + 1));
+    }
+    for (int digit = 1; digit <= Width; ++digit)
+    {
+        if (form.transform.digits[digit] == 0)
+        {
+            form.transform.digits[digit] = next++;
+        }
+    }
+
+    form.transform.apply(cells, form.cells.data());
+    return form;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuCanonicaliser::planCounts()
+{
+    rowCounts.fill(0);
+    colCounts.fill(0);
+
+    for (int cell = 0; cell < CellCount; ++cell)
+    {
+        if (grid[cell] != 0)
+        {
+            ++rowCounts[SudokuUnits::rowOf(cell)];
+            ++colCounts[SudokuUnits::colOf(cell)];
+        }
+    }
+
+    // Fullest first within each band, then the bands in the same order
+    const auto plan = [](const std::array<std::uint8_t, Width>& counts, std::array<std::uint8_t, Width>& target)
+    {
+        std::array<std::array<std::uint8_t, BoxWidth>, BoxWidth> bands{};
+
+        for (int band = 0; band < BoxWidth; ++band)
+        {
+            std::copy_n(counts.begin() + band * BoxWidth, BoxWidth, bands[band].begin());
+            std::sort(bands[band].begin(), bands[band].end(), std::greater<>());
+        }
+        std::sort(bands.begin(), bands.end(), std::greater<>());
+
+        for (int band = 0; band < BoxWidth; ++band)
+        {
+            std::copy_n(bands[band].begin(), BoxWidth, target.begin() + band * BoxWidth);
+        }
+    };
+
+    plan(rowCounts, rowTarget);
+    plan(colCounts, colTarget);
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SudokuCanonicaliser::allowedAt(int line, int level, const std::array<std::uint8_t, Width>& counts,
+                                    const std::array<std::uint8_t, Width>& target, std::uint16_t used)
+{
+    if (counts[line] != target[level])
+    {
+        return false;
+    }
+
+    const bool bandStart = (level % BoxWidth == 0);
+    const auto bandOf = [](int index) { return index / BoxWidth; };
+    const auto bandEmpty = [&](int index)
+    {
+        const int first = bandOf(index) * BoxWidth;
+        return (counts[first] == 0) && (counts[first + 1] == 0) && (counts[first + 2] == 0);
+    };
+
+    if (counts[line] == 0)
+    {
+        for (int other = 0; other < line; ++other)
+        {
+            const bool interchangeable = bandStart ? bandEmpty(other) : (bandOf(other) == bandOf(line));
+
+            if (!(used & (1u << other)) && (counts[other] == 0) && interchangeable)
+            {
+                return false;
+            }
+        }
+    }
+
+    if (!bandStart)
+    {
+        return true;
+    }
+
+    // Starting a band: the whole band must match the next target band
+    std::array<std::uint8_t, BoxWidth> band{};
+
+    std::copy_n(counts.begin() + bandOf(line) * BoxWidth, BoxWidth, band.begin());
+    std::sort(band.begin(), band.end(), std::greater<>());
+    return std::equal(band.begin(), band.end(), target.begin() + level);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuCanonicaliser::search(int level, bool less)
+{
+    if (level == Width)
+    {
+        if (less)
+        {
+            best = image;
+            bestTransform = current;
+            bestTransform.digits = labels.digits;
+            haveBest = true;
+            ++bestCount;
+        }
+        return;
+    }
+
+    // Rows and columns fill one band or stack at a time
+    const int rowBand = (level % BoxWidth == 0) ? -1 : current.rows[level - 1] / BoxWidth;
+    const int colStack = (level % BoxWidth == 0) ? -1 : current.cols[level - 1] / BoxWidth;
+
+    for (int row = 0; row < Width; ++row)
+    {
+        if ((usedRows & (1u << row)) || ((rowBand >= 0) && (row / BoxWidth != rowBand))
+            || !allowedAt(row, level, rowCounts, rowTarget, usedRows))
+        {
+            continue;
+        }
+
+        for (int col = 0; col < Width; ++col)
+        {
+            if ((usedCols & (1u << col)) || ((colStack >= 0) && (col / BoxWidth != colStack))
+                || !allowedAt(col, level, colCounts, colTarget, usedCols))
+            {
+                continue;
+            }
+
+            current.rows[level] = static_cast<std::uint8_t>(row);
+            current.cols[level] = static_cast<std::uint8_t>(col);
+
+            const Labels saved = labels;
+            bool childLess = less;
+
+            if (compareLevel(level, childLess))
+            {
+                const std::uint64_t bestBefore = bestCount;
+
+                usedRows |= static_cast<std::uint16_t>(1u << row);
+                usedCols |= static_cast<std::uint16_t>(1u << col);
+                search(level + 1, childLess);
+                usedRows &= static_cast<std::uint16_t>(~(1u << row));
+                usedCols &= static_cast<std::uint16_t>(~(1u << col));
+
+                // A new best below shares this prefix, so the siblings must beat it outright
+                if (bestCount != bestBefore)
+                {
+                    less = false;
+                }
+            }
+            labels = saved;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SudokuCanonicaliser::compareLevel(int level, bool& less)
+{
+    int position = level * level;
+
+    const auto compare = [&](int row, int col)
+    {
+        const std::uint8_t key = label(grid[current.rows[row] * Width + current.cols[col]]);
+        image[position] = key;
+
+        if (!less)
+        {
+            if (key > best[position])
+            {
+                return false;
+            }
+            less = (key < best[position]);
+        }
+        ++position;
+        return true;
+    };
+
+    for (int col = 0; col <= level; ++col)
+    {
+        if (!compare(level, col))
+        {
+            return false;
+        }
+    }
+    for (int row = 0; row < level; ++row)
+    {
+        if (!compare(row, level))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::uint8_t SudokuCanonicaliser::label(std::uint8_t value)
+{
+    if (value == 0)
+    {
+        return EmptyKey;
+    }
+    if (labels.digits[value] == 0)
+    {
+        labels.digits[value] = labels.next++;
+    }
+    return labels.digits[value];
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "sudoku_units.hpp"
+
+#include <array>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------
+
+// One element of the 9x9 symmetry group: an optional transpose, then a permutation of rows
+// and one of columns that keep bands and stacks together, then a relabelling of the digits.
+
+struct SudokuTransform
+{
+    static constexpr int Width = SudokuUnits::Width;
+
+    bool transposed = false;
+    // Output row i is row rows[i] of the (transposed) input; likewise for columns
+    std::array<std::uint8_t, Width> rows{};
+    std::array<std::uint8_t, Width> cols{};
+    // Output digit of each input digit, with 0 (empty) mapped to itself
+    std::array<std::uint8_t, Width + 1> digits{};
+
+    // Maps 81 row-major cells into the transformed frame, and back again
+    void apply(const std::uint8_t* cells, std::uint8_t* out) const;
+    void invert(const std::uint8_t* cells, std::uint8_t* out) const;
+
+    // Input cell that lands on output cell (row, col)
+    int sourceCell(int row, int col) const
+    {
+        return transposed ? cols[col] * Width + rows[row] : rows[row] * Width + cols[col];
+    }
+};
+
+struct CanonicalForm
+{
+    // The givens in the canonical frame, row-major
+    std::array<std::uint8_t, SudokuUnits::CellCount> cells{};
+    // Maps the board into the canonical frame
+    SudokuTransform transform;
+};
+
+//------------------------------------------------------------------------------------------
+
+// Maps a board to a canonical representative: boards that are rotations, reflections, digit
+// relabellings or band and stack permutations of each other get the same cells. The
+// representative is the smallest image of the board under a key that starts with the
+// number of givens in each row, then in each column, fullest first; those counts do not
+// depend on the digits, so they fix most of the row and column order up front. Ties are
+// broken cell by cell in an L-shaped order: row k and column k are chosen together, which
+// decides the cells (k, 0..k) and (0..k-1, k), and each choice is compared with the best
+// image so far as soon as it is made. Digits are numbered in order of first appearance,
+// and empty cells sort after every digit. Solved grids have no empty cells to go by, so
+// they take far longer than puzzles.
+
+class SudokuCanonicaliser
+{
+public:
+    CanonicalForm canonicalise(const std::uint8_t* cells);
+
+private:
+    static constexpr int Width = SudokuUnits::Width;
+    static constexpr int BoxWidth = SudokuUnits::BoxWidth;
+    static constexpr int CellCount = SudokuUnits::CellCount;
+    // Sort key of an empty cell
+    static constexpr std::uint8_t EmptyKey = Width + 1;
+
+    struct Labels
+    {
+        std::array<std::uint8_t, Width + 1> digits{};
+        std::uint8_t next = 1;
+    };
+
+    // Works out the given counts each row and column position must have
+    void planCounts();
+    // Returns true if a row (or column) with these counts may go at position level. Of
+    // several empty lines that could go there, only the first is tried, as they all give
+    // the same image.
+    static bool allowedAt(int line, int level, const std::array<std::uint8_t, SudokuUnits::Width>& counts,
+                          const std::array<std::uint8_t, SudokuUnits::Width>& target, std::uint16_t used);
+
+    void search(int level, bool less);
+    // Compares the cells decided by row and column level with the best image, returning
+    // false to prune; less is set once the image is known to be smaller
+    bool compareLevel(int level, bool& less);
+    std::uint8_t label(std::uint8_t value);
+
+    // The input, and its transpose when searching the transposed half
+    std::array<std::uint8_t, CellCount> grid{};
+
+    // Givens in each row and column of grid, and the counts at each position of the image,
+    // which are the same for every image with the smallest key
+    std::array<std::uint8_t, Width> rowCounts{};
+    std::array<std::uint8_t, Width> colCounts{};
+    std::array<std::uint8_t, Width> rowTarget{};
+    std::array<std::uint8_t, Width> colTarget{};
+
+    SudokuTransform current;
+    Labels labels;
+    std::array<std::uint8_t, CellCount> image{};
+    std::uint16_t usedRows = 0;
+    std::uint16_t usedCols = 0;
+
+    bool haveBest = false;
+    // Bumped whenever a new best image is found
+    std::uint64_t bestCount = 0;
+    std::array<std::uint8_t, CellCount> best{};
+    SudokuTransform bestTransform;
+};
@@ -1,7 +1,14 @@
-#include <fstream>
+#include <random>
 #include <iostream>
+#include <optional>
 #include <sstream>
 
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+
 #include "sudoku.hpp"
 #include "sudoku_cli_display.hpp"
 
@@ -12,11 +19,7 @@ int SudokuCliDisplay::exec()
     clearScreen();
 
     promptUserDifficulty();
-
-    if (!readFileToSudoku())
-    {
-        return 1;
-    }
+    generateSudoku();
 
     ExitChoice choice = playSudoku();
 
@@ -41,6 +44,21 @@ void SudokuCliDisplay::clearScreen() const
 
 //------------------------------------------------------------------------------------------
 
+void SudokuCliDisplay::printSudoku() const
+{
+    #ifdef _WIN32
+        const bool toTerminal = _isatty(_fileno(stdout));
+    #else
+        const bool toTerminal = isatty(fileno(stdout));
+    #endif
+
+    char buffer[Sudoku::MaxRenderLength];
+    const std::size_t length = sudoku.render(buffer, toTerminal ? Sudoku::RenderStyle::Colour : Sudoku::RenderStyle::Plain);
+    std::cout.write(buffer, static_cast<std::streamsize>(length));
+}
+
+//------------------------------------------------------------------------------------------
+
 void SudokuCliDisplay::promptUserDifficulty()
 {
     while (true)
@@ -54,7 +72,6 @@ void SudokuCliDisplay::promptUserDifficulty()
         if (choiceIt != inputToDifficulty.end())
         {
             difficulty = choiceIt->second;
-            fileName = difficultyToFileName.at(difficulty);
             return;
         }
         else
@@ -67,24 +84,13 @@ void SudokuCliDisplay::promptUserDifficulty()
 
 //------------------------------------------------------------------------------------------
 
-bool SudokuCliDisplay::readFileToSudoku()
+void SudokuCliDisplay::generateSudoku()
 {
-    std::ifstream file{ sudokuCsvFolder + fileName + fileType };
+    std::cout << "Generating sudoku... \n";
 
-    if (!file.is_open())
-    {
-        std::cerr << "Error opening file. \n";
-        return false;
-    }
-    if (!sudoku.readFromCsv(file, ','))
-    {
-        std::cerr << "Error reading file. \n";
-        file.close();
-        return false;
-    }
-
-    file.close();
-    return true;
+    std::random_device seed;
+    SudokuGenerator generator((static_cast<std::uint64_t>(seed()) << 32) | seed());
+    sudoku = generator.generate(difficulty);
 }
 
 //------------------------------------------------------------------------------------------
@@ -93,17 +99,33 @@ void SudokuCliDisplay::solveSudoku()
 {
     clearScreen();
 
-    std::string solverVisibilityPrompt;
-    solverVisibilityPrompt += "Would you like to watch the sudoku be solved? \n";
-    solverVisibilityPrompt += "This drastically slows down the algorithm, but it looks cool. \n";
-    solverVisibilityPrompt += "Warning: on Windows terminals this results in very jittery output. \n";
+    const Sudoku::SolverStrategy strategy = promptUserSolverStrategy();
+    sudoku.setSolverStrategy(strategy);
+    sudoku.setSolverDisplay(false);
+
+    if (strategy == Sudoku::SolverStrategy::DepthFirst)
+    {
+        std::string solverVisibilityPrompt;
+        solverVisibilityPrompt += "Would you like to watch the sudoku be solved? \n";
+        solverVisibilityPrompt += "The board is redrawn in place 30 times a second while the solver runs. \n";
+
+        sudoku.setSolverDisplay(promptUserYesNo(solverVisibilityPrompt));
+    }
 
-    sudoku.setSolverDisplay(promptUserYesNo(solverVisibilityPrompt));
+    SolverStats stats;
+    stats.recordDepthHistogram = showStats;
 
-    sudoku.solve();
+    sudoku.solve(stats);
     clearScreen();
-    std::cout << sudoku << "\n";
+    printSudoku();
+    std::cout << "\n";
     std::cout << "Here's the solved sudoku!" << "\n";
+    std::cout << "The solver made " << stats.guesses << " guesses and " << stats.backtracks << " backtracks. \n";
+
+    if (showStats)
+    {
+        std::cout << stats;
+    }
 }
 
 //------------------------------------------------------------------------------------------
@@ -114,8 +136,10 @@ SudokuCliDisplay::ExitChoice SudokuCliDisplay::playSudoku()
 
     while (true)
     {
-        std::cout << "\n" << sudoku << "\n";
-        std::cout << "Enter a move (x,y,val), 'quit', or 'solve': \n";
+        std::cout << "\n";
+        printSudoku();
+        std::cout << "\n";
+        std::cout << "Enter a move (x,y,val), 'hint', 'quit', or 'solve': \n";
         std::getline(std::cin, input);
 
         std::istringstream inputstream{ input };
@@ -135,22 +159,33 @@ SudokuCliDisplay::ExitChoice SudokuCliDisplay::playSudoku()
             return ExitChoice::Solve;
         }
 
-        int x{};
-        int y{};
-        int val{};
-        char delim1{};
-        char delim2{};
-
-        inputstream >> x >> delim1 >> y >> delim2 >> val;
-
-        if (!inputstream || (delim1 != ',') || (delim2 != ',')
-            || !sudoku.setNumber(y, x, val))
+        if (input == "hint")
         {
-            std::cout << "Invalid input or move. Please try again. \n";
+            showHint();
         }
         else
         {
-            std::cout << "Move accepted. \n";
+            int x{};
+            int y{};
+            int val{};
+            char delim1{};
+            char delim2{};
+
+            inputstream >> x >> delim1 >> y >> delim2 >> val;
+
+            if (!inputstream || (delim1 != ',') || (delim2 != ',')
+                || !sudoku.setNumber(y, x, val))
+            {
+                std::cout << "Invalid input or move. Please try again. \n";
+            }
+            else if ((val != 0) && sudoku.hasConflict(y, x))
+            {
+                std::cout << "Move accepted, but it clashes with a " << val << " in the same row, column or box. \n";
+            }
+            else
+            {
+                std::cout << "Move accepted. \n";
+            }
         }
 
         if (sudoku.isDone())
@@ -176,6 +211,62 @@ SudokuCliDisplay::ExitChoice SudokuCliDisplay::playSudoku()
 
 //------------------------------------------------------------------------------------------
 
+void SudokuCliDisplay::showHint()
+{
+    const std::optional<Sudoku::Hint> hint = sudoku.findHint();
+
+    if (!hint)
+    {
+        if (!sudoku.isValid())
+        {
+            std::cout << "No hint while the board has a clash; the clashing cells are highlighted. \n";
+        }
+        else
+        {
+            std::cout << "No cell is forced by the digits placed so far. \n";
+        }
+        return;
+    }
+
+    sudoku.setNumber(hint->rowIndex, hint->colIndex, hint->value);
+    std::cout << "Hint: " << hint->colIndex << "," << hint->rowIndex << "," << hint->value << " - ";
+
+    if (hint->reason == Sudoku::Hint::Reason::NakedSingle)
+    {
+        std::cout << "it is the only digit left for that cell. \n";
+    }
+    else
+    {
+        static const char* const unitNames[] = { "row", "column", "box" };
+        std::cout << "it is the only place left for a " << hint->value << " in its "
+                  << unitNames[hint->unit / Sudoku::SudokuWidth] << ". \n";
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+Sudoku::SolverStrategy SudokuCliDisplay::promptUserSolverStrategy() const
+{
+    while (true)
+    {
+        std::cout << "Which solver would you like to use? \n"
+                  << "'depth' for depth-first, 'propagation' for constraint propagation, 'dlx' for dancing links, \n"
+                  << "'iterative' for depth-first without recursion, 'deduction' for propagation with human-style techniques. \n";
+        std::string strategyChoice;
+        std::getline(std::cin, strategyChoice);
+
+        const auto choiceIt = inputToSolverStrategy.find(strategyChoice);
+        if (choiceIt != inputToSolverStrategy.end())
+        {
+            return choiceIt->second;
+        }
+
+        std::cout << "Invalid choice. \n";
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
 bool SudokuCliDisplay::promptUserYesNo(const std::string& message) const
 {
     std::string input;
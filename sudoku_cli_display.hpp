@@ -1,6 +1,7 @@
 #pragma once
 
 #include "sudoku.hpp"
+#include "sudoku_generator.hpp"
 
 #include <unordered_map>
 
@@ -13,7 +14,8 @@ public:
 
     void promptUserDifficulty();
 
-    bool readFileToSudoku();
+    // Fills the board with a new puzzle of the chosen difficulty
+    void generateSudoku();
 
     void solveSudoku();
 
@@ -24,30 +26,24 @@ public:
     };
 
     ExitChoice playSudoku();
+    // Fills in the next cell forced by a single and says why
+    void showHint();
 
     void clearScreen() const;
 
-    void setSudokuCsvFolder(const std::string& folder) { sudokuCsvFolder = folder; }
-    void setFileName(const std::string& file) { fileName = file; }
-    void setFileType(const std::string& fileSuffix) { fileType = fileSuffix; }
+    // Prints the board, without colour codes when stdout is not a terminal
+    void printSudoku() const;
 
-private:
-    enum class Difficulty
-    {
-        Easy,
-        Medium,
-        Hard,
-        WorldsHardest,
-    };
+    // Prints the full solver statistics after solveSudoku
+    void setShowStats(bool status) { showStats = status; }
 
+private:
     bool promptUserYesNo(const std::string&) const;
+    Sudoku::SolverStrategy promptUserSolverStrategy() const;
 
     Sudoku sudoku;
-    Difficulty difficulty;
-
-    std::string sudokuCsvFolder = "sudoku_examples/";
-    std::string fileName = "easy";
-    std::string fileType = ".csv";
+    Difficulty difficulty = Difficulty::Easy;
+    bool showStats = false;
 
     static inline const std::unordered_map<std::string, Difficulty> inputToDifficulty =
     {
@@ -57,11 +53,12 @@ private:
         {"xxxx", Difficulty::WorldsHardest}
     };
 
-    static inline const std::unordered_map<Difficulty, std::string> difficultyToFileName =
+    static inline const std::unordered_map<std::string, Sudoku::SolverStrategy> inputToSolverStrategy =
     {
-        {Difficulty::Easy,          "easy"},
-        {Difficulty::Medium,        "medium"},
-        {Difficulty::Hard,          "hard"},
-        {Difficulty::WorldsHardest, "worlds_hardest"}
+        {"depth",       Sudoku::SolverStrategy::DepthFirst},
+        {"propagation", Sudoku::SolverStrategy::Propagation},
+        {"dlx",         Sudoku::SolverStrategy::DancingLinks},
+        {"iterative",   Sudoku::SolverStrategy::Iterative},
+        {"deduction",   Sudoku::SolverStrategy::Deduction}
     };
 };
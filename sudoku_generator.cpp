@@ -0,0 +1,201 @@
+#include "sudoku_generator.hpp"
+
+#include "sudoku_units.hpp"
+
+#include <numeric>
+#include <utility>
+
+//------------------------------------------------------------------------------------------
+
+Sudoku SudokuGenerator::generate(Difficulty difficulty)
+{
+    Cells solution;
+    randomSolution(solution);
+
+    Cells best = solution;
+    SolverStats bestEffort = removeClues(best, difficulty);
+
+    // Short of difficulty, a few clues go back into the hardest puzzle so far and are removed
+    // again in a new order; a result that is no easier replaces it. Each round only redoes
+    // the tail of the removal, where the grade is decided.
+    for (int round = 1; (round < MaxRounds) && (grade(bestEffort) < difficulty); ++round)
+    {
+        Cells cells = best;
+        restoreClues(cells, solution, RestoredClues);
+
+        const SolverStats effort = removeClues(cells, difficulty);
+
+        if (!isHarder(bestEffort, effort))
+        {
+            best = cells;
+            bestEffort = effort;
+        }
+    }
+
+    Sudoku puzzle;
+    puzzle.loadGivens(best.data());
+    return puzzle;
+}
+
+//------------------------------------------------------------------------------------------
+
+Difficulty SudokuGenerator::grade(const SolverStats& stats)
+{
+    if (stats.guesses == 0)
+    {
+        return (stats.hiddenSingles == 0) ? Difficulty::Easy : Difficulty::Medium;
+    }
+    return (stats.guesses < WorldsHardestGuesses) ? Difficulty::Hard : Difficulty::WorldsHardest;
+}
+
+//------------------------------------------------------------------------------------------
+
+std::uint64_t SudokuGenerator::puzzleSeed(std::uint64_t runSeed, std::uint64_t index)
+{
+    // SplitMix64 finaliser over the run seed and the puzzle number
+    std::uint64_t z = runSeed + (index + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuGenerator::randomSolution(Cells& cells)
+{
+    cells.fill(0);
+
+    for (int box = 0; box < SudokuUnits::Width; box += SudokuUnits::BoxWidth + 1)
+    {
+        std::array<std::uint8_t, SudokuUnits::Width> digits;
+        std::iota(digits.begin(), digits.end(), 1);
+
+        for (int i = SudokuUnits::Width - 1; i > 0; --i)
+        {
+            std::swap(digits[i], digits[randomBelow(i + 1)]);
+        }
+
+        const auto& boxCells = unitCells[2 * SudokuUnits::Width + box];
+        for (int i = 0; i < SudokuUnits::Width; ++i)
+        {
+            cells[boxCells[i]] = digits[i];
+        }
+    }
+
+    // Any filling of the diagonal boxes can be completed
+    Sudoku grid;
+    grid.loadGivens(cells.data());
+    grid.setSolverStrategy(Sudoku::SolverStrategy::Propagation);
+    grid.solve();
+
+    char line[Sudoku::LineLength];
+    grid.writeToLine(line);
+
+    for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+    {
+        cells[cell] = static_cast<std::uint8_t>(line[cell] - '0');
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+SolverStats SudokuGenerator::removeClues(Cells& cells, Difficulty difficulty)
+{
+    std::array<std::uint8_t, SudokuUnits::CellCount> order;
+    std::iota(order.begin(), order.end(), 0);
+
+    for (int i = SudokuUnits::CellCount - 1; i > 0; --i)
+    {
+        std::swap(order[i], order[randomBelow(i + 1)]);
+    }
+
+    Sudoku puzzle;
+    puzzle.loadGivens(cells.data());
+
+    SolverStats reached;
+    solver.countSolutions(puzzle, 2, reached);
+    reached = solver.firstSolutionStats();
+
+    for (const int cell : order)
+    {
+        const std::uint8_t clue = cells[cell];
+
+        if (clue == 0)
+        {
+            continue;
+        }
+        cells[cell] = 0;
+
+        // Propagation puts a forced clue straight back and then searches exactly as before,
+        // so neither uniqueness nor the grade can change
+        if (isForced(cells, cell))
+        {
+            continue;
+        }
+        puzzle.loadGivens(cells.data());
+
+        // One search both checks uniqueness and grades the first solution
+        SolverStats stats;
+        const bool unique = (solver.countSolutions(puzzle, 2, stats) == 1);
+
+        if (unique && (grade(solver.firstSolutionStats()) <= difficulty))
+        {
+            reached = solver.firstSolutionStats();
+        }
+        else
+        {
+            cells[cell] = clue;
+        }
+    }
+    return reached;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuGenerator::restoreClues(Cells& cells, const Cells& solution, int count)
+{
+    std::array<std::uint8_t, SudokuUnits::CellCount> empty;
+    int emptyCount = 0;
+
+    for (int cell = 0; cell < SudokuUnits::CellCount; ++cell)
+    {
+        if (cells[cell] == 0)
+        {
+            empty[emptyCount++] = static_cast<std::uint8_t>(cell);
+        }
+    }
+
+    // Partial shuffle: the first count of the empty cells end up a random pick
+    for (int i = 0; (i < count) && (i < emptyCount); ++i)
+    {
+        std::swap(empty[i], empty[i + randomBelow(emptyCount - i)]);
+        cells[empty[i]] = solution[empty[i]];
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SudokuGenerator::isForced(const Cells& cells, int cell)
+{
+    CandidateMask taken = 0;
+
+    for (const int peer : cellPeers[cell])
+    {
+        if (cells[peer] != 0)
+        {
+            taken |= static_cast<CandidateMask>(1u << (cells[peer] - 1));
+        }
+    }
+    return digitCounts[taken] == SudokuUnits::Width - 1;
+}
+
+//------------------------------------------------------------------------------------------
+
+bool SudokuGenerator::isHarder(const SolverStats& first, const SolverStats& second)
+{
+    if (first.guesses != second.guesses)
+    {
+        return first.guesses > second.guesses;
+    }
+    return first.hiddenSingles > second.hiddenSingles;
+}
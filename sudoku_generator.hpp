@@ -0,0 +1,77 @@
+#pragma once
+
+#include "propagation_solver.hpp"
+#include "sudoku.hpp"
+
+#include <array>
+#include <cstdint>
+#include <random>
+
+//------------------------------------------------------------------------------------------
+
+enum class Difficulty
+{
+    // Solved by cells with a single candidate alone
+    Easy,
+    // Also needs digits with a single place left in a row, column or box
+    Medium,
+    // Needs some guessing
+    Hard,
+    // Needs a lot of guessing
+    WorldsHardest,
+};
+
+//------------------------------------------------------------------------------------------
+
+// Generates uniquely solvable puzzles. Difficulty is graded by what the propagation solver
+// needs to solve a puzzle, not by how many clues it has. Generators built from the same
+// seed produce the same puzzles.
+
+class SudokuGenerator
+{
+public:
+    explicit SudokuGenerator(std::uint64_t seed) : rng(seed) {}
+
+    // Starts over as if built from seed, so one generator can serve a whole run
+    void reseed(std::uint64_t seed) { rng.seed(seed); }
+
+    // Returns a puzzle with a unique solution; it is graded at difficulty unless MaxRounds
+    // rounds all fell short, in which case the hardest one found is returned
+    Sudoku generate(Difficulty);
+
+    // Grades a puzzle with a unique solution from the propagation solver's effort on it
+    static Difficulty grade(const SolverStats&);
+
+    // Seed of puzzle number index in a run, so the output does not depend on how the run
+    // is split between threads
+    static std::uint64_t puzzleSeed(std::uint64_t runSeed, std::uint64_t index);
+
+private:
+    using Cells = std::array<std::uint8_t, Sudoku::LineLength>;
+
+    // Fills the three independent diagonal boxes at random and completes the grid
+    void randomSolution(Cells&);
+
+    // Removes clues in random order while the puzzle stays unique and no harder than
+    // difficulty, returning the propagation solver's effort on what is left
+    SolverStats removeClues(Cells&, Difficulty);
+    // Puts count clues of solution back into the cells, picked at random among the empty ones
+    void restoreClues(Cells&, const Cells& solution, int count);
+
+    // Returns true if the clues of the peers of cell leave it a single digit
+    static bool isForced(const Cells&, int cell);
+    // Returns true if the first effort is further along the grades than the second
+    static bool isHarder(const SolverStats&, const SolverStats&);
+
+    // Uniform enough for shuffling, and identical on every standard library
+    int randomBelow(int bound) { return static_cast<int>(rng() % static_cast<std::uint64_t>(bound)); }
+
+    std::mt19937_64 rng;
+    PropagationSolver solver;
+
+    static constexpr int MaxRounds = 1000;
+    // Clues put back before each further round of removal
+    static constexpr int RestoredClues = 8;
+    // Guesses the propagation solver needs before a puzzle counts as one of the hardest
+    static constexpr std::uint64_t WorldsHardestGuesses = 20;
+};
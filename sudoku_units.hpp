@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+//------------------------------------------------------------------------------------------
+
+// Compile-time index tables for a board of BoxSize x BoxSize boxes: the units (rows, then
+// columns, then boxes) and the peers that share a unit with each cell. Every table is built
+// by a constexpr function, so each board size gets its own fixed-bound loops.
+
+template <int BoxSize>
+struct BasicSudokuUnits
+{
+    static constexpr int Width = BoxSize * BoxSize;
+    static constexpr int BoxWidth = BoxSize;
+    static constexpr int CellCount = Width * Width;
+    static constexpr int UnitCount = 3 * Width;
+    // The rest of the row and column, plus the box cells outside both
+    static constexpr int PeerCount = 2 * (Width - 1) + (BoxWidth - 1) * (BoxWidth - 1);
+
+    // Smallest type that can hold a cell index
+    using CellIndex = std::conditional_t<(CellCount <= 256), std::uint8_t, std::uint16_t>;
+
+    using UnitTable = std::array<std::array<CellIndex, Width>, UnitCount>;
+    using PeerTable = std::array<std::array<CellIndex, PeerCount>, CellCount>;
+    using CellUnitTable = std::array<std::array<std::uint8_t, 3>, CellCount>;
+
+    static constexpr int rowOf(int cell) { return cell / Width; }
+    static constexpr int colOf(int cell) { return cell % Width; }
+    static constexpr int boxOf(int cell) { return (rowOf(cell) / BoxWidth) * BoxWidth + (colOf(cell) / BoxWidth); }
+};
+
+// The classic 9x9 board, which the solvers are written for
+using SudokuUnits = BasicSudokuUnits<3>;
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+constexpr typename BasicSudokuUnits<BoxSize>::UnitTable makeUnitTable()
+{
+    using Units = BasicSudokuUnits<BoxSize>;
+    using CellIndex = typename Units::CellIndex;
+    typename Units::UnitTable units{};
+
+    for (int i = 0; i < Units::Width; ++i)
+    {
+        for (int j = 0; j < Units::Width; ++j)
+        {
+            const int boxRow = (i / Units::BoxWidth) * Units::BoxWidth + j / Units::BoxWidth;
+            const int boxCol = (i % Units::BoxWidth) * Units::BoxWidth + j % Units::BoxWidth;
+
+            units[i][j] = static_cast<CellIndex>(i * Units::Width + j);
+            units[Units::Width + i][j] = static_cast<CellIndex>(j * Units::Width + i);
+            units[2 * Units::Width + i][j] = static_cast<CellIndex>(boxRow * Units::Width + boxCol);
+        }
+    }
+    return units;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+constexpr typename BasicSudokuUnits<BoxSize>::PeerTable makePeerTable()
+{
+    using Units = BasicSudokuUnits<BoxSize>;
+    typename Units::PeerTable peers{};
+
+    for (int cell = 0; cell < Units::CellCount; ++cell)
+    {
+        int peerCount = 0;
+
+        for (int other = 0; other < Units::CellCount; ++other)
+        {
+            const bool sharesUnit = (Units::rowOf(cell) == Units::rowOf(other)) ||
+                                    (Units::colOf(cell) == Units::colOf(other)) ||
+                                    (Units::boxOf(cell) == Units::boxOf(other));
+
+            if ((other != cell) && sharesUnit)
+            {
+                peers[cell][peerCount++] = static_cast<typename Units::CellIndex>(other);
+            }
+        }
+    }
+    return peers;
+}
+
+//------------------------------------------------------------------------------------------
+
+template <int BoxSize>
+constexpr typename BasicSudokuUnits<BoxSize>::CellUnitTable makeCellUnitTable()
+{
+    using Units = BasicSudokuUnits<BoxSize>;
+    typename Units::CellUnitTable cellUnits{};
+
+    for (int cell = 0; cell < Units::CellCount; ++cell)
+    {
+        cellUnits[cell][0] = static_cast<std::uint8_t>(Units::rowOf(cell));
+        cellUnits[cell][1] = static_cast<std::uint8_t>(Units::Width + Units::colOf(cell));
+        cellUnits[cell][2] = static_cast<std::uint8_t>(2 * Units::Width + Units::boxOf(cell));
+    }
+    return cellUnits;
+}
+
+//------------------------------------------------------------------------------------------
+
+// Tables are only built for the board sizes that use them
+template <int BoxSize>
+inline constexpr typename BasicSudokuUnits<BoxSize>::UnitTable basicUnitCells = makeUnitTable<BoxSize>();
+template <int BoxSize>
+inline constexpr typename BasicSudokuUnits<BoxSize>::PeerTable basicCellPeers = makePeerTable<BoxSize>();
+template <int BoxSize>
+inline constexpr typename BasicSudokuUnits<BoxSize>::CellUnitTable basicCellUnits = makeCellUnitTable<BoxSize>();
+
+inline constexpr const SudokuUnits::UnitTable& unitCells = basicUnitCells<3>;
+inline constexpr const SudokuUnits::PeerTable& cellPeers = basicCellPeers<3>;
+inline constexpr const SudokuUnits::CellUnitTable& cellUnits = basicCellUnits<3>;
+
+//------------------------------------------------------------------------------------------
+
+// Candidate masks use bit (digit - 1) for each digit still possible in a cell, in the
+// smallest unsigned type with a bit per digit
+template <int BoxSize>
+using BasicCandidateMask = std::conditional_t<(BoxSize * BoxSize <= 16), std::uint16_t, std::uint32_t>;
+
+using CandidateMask = BasicCandidateMask<3>;
+
+inline constexpr CandidateMask AllDigits = (1u << SudokuUnits::Width) - 1;
+
+constexpr std::array<std::uint8_t, AllDigits + 1> makeDigitCountTable()
+{
+    std::array<std::uint8_t, AllDigits + 1> counts{};
+
+    for (int mask = 1; mask <= AllDigits; ++mask)
+    {
+        counts[mask] = static_cast<std::uint8_t>(counts[mask & (mask - 1)] + 1);
+    }
+    return counts;
+}
+
+inline constexpr std::array<std::uint8_t, AllDigits + 1> digitCounts = makeDigitCountTable();
+
+constexpr bool isSingleDigit(CandidateMask mask) { return (mask != 0) && ((mask & (mask - 1)) == 0); }
+
+constexpr CandidateMask lowestDigitBit(CandidateMask mask) { return mask & static_cast<CandidateMask>(-mask); }
+
+// Digit of the lowest set bit in a non-empty mask
+constexpr int lowestDigit(CandidateMask mask)
+{
+    int digit = 1;
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        ++digit;
+    }
+    return digit;
+}
@@ -0,0 +1,339 @@
+#include "sudoku_validator.hpp"
+
+#include "sudoku_units.hpp"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #define SUDOKU_VALIDATOR_X86 1
+    #include <immintrin.h>
+#endif
+
+//------------------------------------------------------------------------------------------
+
+namespace
+{
+    BoardCheck checkScalar(const std::uint8_t* cells)
+    {
+        BoardCheck result{ true, true };
+
+        for (const auto& unit : unitCells)
+        {
+            CandidateMask seen = 0;
+
+            for (const int cell : unit)
+            {
+                const int value = cells[cell];
+
+                if (value == 0)
+                {
+                    result.full = false;
+                    continue;
+                }
+
+                const CandidateMask bit = static_cast<CandidateMask>(1u << (value - 1));
+                if ((seen & bit) != 0)
+                {
+                    result.valid = false;
+                }
+                seen |= bit;
+            }
+        }
+        return result;
+    }
+
+    void checkBatchScalar(const std::uint8_t* boards, std::size_t count, BoardCheck* results)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            results[i] = checkScalar(boards + i * SudokuValidator::BoardSize);
+        }
+    }
+
+#ifdef SUDOKU_VALIDATOR_X86
+
+    // Each digit becomes one bit of a 16-bit lane: (1 << (value - 1)), split into a low and
+    // a high byte plane. A unit has no duplicates exactly when the sum of its bits equals
+    // their OR, since any repeated bit carries. Rows are spread over 16 lanes with a gap
+    // after each box (lanes 0-2, 4-6 and 8-10), so box sums line up with byte shifts.
+
+    __attribute__((target("sse4.1")))
+    void loadRowSse41(const std::uint8_t* padded, int row, __m128i& low, __m128i& high)
+    {
+        const __m128i spreadBoxes = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, -1, -1, -1, -1);
+        const __m128i lowBits = _mm_setr_epi8(0, 1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i highBits = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0);
+
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(padded + row * SudokuUnits::Width));
+        const __m128i spread = _mm_shuffle_epi8(bytes, spreadBoxes);
+        const __m128i lowPlane = _mm_shuffle_epi8(lowBits, spread);
+        const __m128i highPlane = _mm_shuffle_epi8(highBits, spread);
+
+        low = _mm_unpacklo_epi8(lowPlane, highPlane);
+        high = _mm_unpackhi_epi8(lowPlane, highPlane);
+    }
+
+    __attribute__((target("sse4.1")))
+    __m128i sumOfThreeLanes(__m128i lanes)
+    {
+        return _mm_add_epi16(lanes, _mm_add_epi16(_mm_srli_si128(lanes, 2), _mm_srli_si128(lanes, 4)));
+    }
+
+    __attribute__((target("sse4.1")))
+    __m128i orOfThreeLanes(__m128i lanes)
+    {
+        return _mm_or_si128(lanes, _mm_or_si128(_mm_srli_si128(lanes, 2), _mm_srli_si128(lanes, 4)));
+    }
+
+    __attribute__((target("sse4.1")))
+    bool lanesEqual(__m128i a, __m128i b, int byteMask)
+    {
+        return (_mm_movemask_epi8(_mm_cmpeq_epi16(a, b)) & byteMask) == byteMask;
+    }
+
+    __attribute__((target("sse4.1")))
+    BoardCheck checkSse41(const std::uint8_t* cells)
+    {
+        alignas(16) std::uint8_t padded[96];
+        std::memcpy(padded, cells, SudokuValidator::BoardSize);
+        std::memset(padded + SudokuValidator::BoardSize, 1, sizeof(padded) - SudokuValidator::BoardSize);
+
+        // Lanes 0-7 and 8-15 of the spread rows
+        __m128i columnSumLow = _mm_setzero_si128();
+        __m128i columnSumHigh = _mm_setzero_si128();
+        __m128i columnOrLow = _mm_setzero_si128();
+        __m128i columnOrHigh = _mm_setzero_si128();
+        bool valid = true;
+
+        for (int band = 0; band < SudokuUnits::BoxWidth; ++band)
+        {
+            __m128i bandSumLow = _mm_setzero_si128();
+            __m128i bandSumHigh = _mm_setzero_si128();
+            __m128i bandOrLow = _mm_setzero_si128();
+            __m128i bandOrHigh = _mm_setzero_si128();
+
+            for (int row = band * SudokuUnits::BoxWidth; row < (band + 1) * SudokuUnits::BoxWidth; ++row)
+            {
+                __m128i low;
+                __m128i high;
+                loadRowSse41(padded, row, low, high);
+
+                // Row total lands in lane 0: boxes 0 and 1 from the low half, box 2 from the high
+                const __m128i rowSum = sumOfThreeLanes(low);
+                const __m128i rowOr = orOfThreeLanes(low);
+                const __m128i rowTotalSum = _mm_add_epi16(_mm_add_epi16(rowSum, _mm_srli_si128(rowSum, 8)), sumOfThreeLanes(high));
+                const __m128i rowTotalOr = _mm_or_si128(_mm_or_si128(rowOr, _mm_srli_si128(rowOr, 8)), orOfThreeLanes(high));
+                valid &= lanesEqual(rowTotalSum, rowTotalOr, 0x0003);
+
+                bandSumLow = _mm_add_epi16(bandSumLow, low);
+                bandSumHigh = _mm_add_epi16(bandSumHigh, high);
+                bandOrLow = _mm_or_si128(bandOrLow, low);
+                bandOrHigh = _mm_or_si128(bandOrHigh, high);
+            }
+
+            valid &= lanesEqual(sumOfThreeLanes(bandSumLow), orOfThreeLanes(bandOrLow), 0x0303);
+            valid &= lanesEqual(sumOfThreeLanes(bandSumHigh), orOfThreeLanes(bandOrHigh), 0x0003);
+
+            columnSumLow = _mm_add_epi16(columnSumLow, bandSumLow);
+            columnSumHigh = _mm_add_epi16(columnSumHigh, bandSumHigh);
+            columnOrLow = _mm_or_si128(columnOrLow, bandOrLow);
+            columnOrHigh = _mm_or_si128(columnOrHigh, bandOrHigh);
+        }
+
+        valid &= lanesEqual(columnSumLow, columnOrLow, 0xFFFF);
+        valid &= lanesEqual(columnSumHigh, columnOrHigh, 0xFFFF);
+
+        const __m128i zero = _mm_setzero_si128();
+        __m128i empty = zero;
+        for (int offset = 0; offset < 96; offset += 16)
+        {
+            const __m128i bytes = _mm_load_si128(reinterpret_cast<const __m128i*>(padded + offset));
+            empty = _mm_or_si128(empty, _mm_cmpeq_epi8(bytes, zero));
+        }
+
+        return BoardCheck{ valid, _mm_testz_si128(empty, empty) != 0 };
+    }
+
+    __attribute__((target("sse4.1")))
+    void checkBatchSse41(const std::uint8_t* boards, std::size_t count, BoardCheck* results)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            results[i] = checkSse41(boards + i * SudokuValidator::BoardSize);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    __m256i loadRowAvx2(const std::uint8_t* padded, int row)
+    {
+        const __m128i spreadBoxes = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, -1, -1, -1, -1);
+        const __m128i lowBits = _mm_setr_epi8(0, 1, 2, 4, 8, 16, 32, 64, -128, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i highBits = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0);
+
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(padded + row * SudokuUnits::Width));
+        const __m128i spread = _mm_shuffle_epi8(bytes, spreadBoxes);
+        const __m128i lowPlane = _mm_shuffle_epi8(lowBits, spread);
+        const __m128i highPlane = _mm_shuffle_epi8(highBits, spread);
+
+        return _mm256_set_m128i(_mm_unpackhi_epi8(lowPlane, highPlane), _mm_unpacklo_epi8(lowPlane, highPlane));
+    }
+
+    __attribute__((target("avx2")))
+    __m256i sumOfThreeLanes(__m256i lanes)
+    {
+        return _mm256_add_epi16(lanes, _mm256_add_epi16(_mm256_srli_si256(lanes, 2), _mm256_srli_si256(lanes, 4)));
+    }
+
+    __attribute__((target("avx2")))
+    __m256i orOfThreeLanes(__m256i lanes)
+    {
+        return _mm256_or_si256(lanes, _mm256_or_si256(_mm256_srli_si256(lanes, 2), _mm256_srli_si256(lanes, 4)));
+    }
+
+    __attribute__((target("avx2")))
+    bool lanesEqual(__m256i a, __m256i b, unsigned byteMask)
+    {
+        const unsigned equal = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(a, b)));
+        return (equal & byteMask) == byteMask;
+    }
+
+    __attribute__((target("avx2")))
+    BoardCheck checkAvx2(const std::uint8_t* cells)
+    {
+        alignas(32) std::uint8_t padded[96];
+        std::memcpy(padded, cells, SudokuValidator::BoardSize);
+        std::memset(padded + SudokuValidator::BoardSize, 1, sizeof(padded) - SudokuValidator::BoardSize);
+
+        __m256i columnSum = _mm256_setzero_si256();
+        __m256i columnOr = _mm256_setzero_si256();
+        bool valid = true;
+
+        for (int band = 0; band < SudokuUnits::BoxWidth; ++band)
+        {
+            __m256i bandSum = _mm256_setzero_si256();
+            __m256i bandOr = _mm256_setzero_si256();
+
+            for (int row = band * SudokuUnits::BoxWidth; row < (band + 1) * SudokuUnits::BoxWidth; ++row)
+            {
+                const __m256i bits = loadRowAvx2(padded, row);
+
+                // Box totals sit in lanes 0, 4 and 8; fold them into lane 0 of the low half
+                const __m256i boxSums = sumOfThreeLanes(bits);
+                const __m256i boxOrs = orOfThreeLanes(bits);
+                const __m256i pairSums = _mm256_add_epi16(boxSums, _mm256_srli_si256(boxSums, 8));
+                const __m256i pairOrs = _mm256_or_si256(boxOrs, _mm256_srli_si256(boxOrs, 8));
+                const __m128i rowSum = _mm_add_epi16(_mm256_castsi256_si128(pairSums), _mm256_extracti128_si256(pairSums, 1));
+                const __m128i rowOr = _mm_or_si128(_mm256_castsi256_si128(pairOrs), _mm256_extracti128_si256(pairOrs, 1));
+                valid &= (_mm_movemask_epi8(_mm_cmpeq_epi16(rowSum, rowOr)) & 0x0003) == 0x0003;
+
+                bandSum = _mm256_add_epi16(bandSum, bits);
+                bandOr = _mm256_or_si256(bandOr, bits);
+            }
+
+            valid &= lanesEqual(sumOfThreeLanes(bandSum), orOfThreeLanes(bandOr), 0x00030303u);
+
+            columnSum = _mm256_add_epi16(columnSum, bandSum);
+            columnOr = _mm256_or_si256(columnOr, bandOr);
+        }
+
+        valid &= lanesEqual(columnSum, columnOr, 0xFFFFFFFFu);
+
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i empty = zero;
+        for (int offset = 0; offset < 96; offset += 32)
+        {
+            const __m256i bytes = _mm256_load_si256(reinterpret_cast<const __m256i*>(padded + offset));
+            empty = _mm256_or_si256(empty, _mm256_cmpeq_epi8(bytes, zero));
+        }
+
+        return BoardCheck{ valid, _mm256_testz_si256(empty, empty) != 0 };
+    }
+
+    __attribute__((target("avx2")))
+    void checkBatchAvx2(const std::uint8_t* boards, std::size_t count, BoardCheck* results)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            results[i] = checkAvx2(boards + i * SudokuValidator::BoardSize);
+        }
+    }
+
+#endif
+
+    bool isSupported(SudokuValidator::Kernel kernel)
+    {
+        switch (kernel)
+        {
+            #ifdef SUDOKU_VALIDATOR_X86
+                case SudokuValidator::Kernel::Avx2:
+                    return __builtin_cpu_supports("avx2");
+                case SudokuValidator::Kernel::Sse41:
+                    return __builtin_cpu_supports("sse4.1");
+            #endif
+            default:
+                return kernel == SudokuValidator::Kernel::Scalar;
+        }
+    }
+
+    SudokuValidator::Kernel bestKernel()
+    {
+        for (const auto kernel : { SudokuValidator::Kernel::Avx2, SudokuValidator::Kernel::Sse41 })
+        {
+            if (isSupported(kernel))
+            {
+                return kernel;
+            }
+        }
+        return SudokuValidator::Kernel::Scalar;
+    }
+
+    SudokuValidator::Kernel selectedKernel = bestKernel();
+}
+
+//------------------------------------------------------------------------------------------
+
+BoardCheck SudokuValidator::check(const std::uint8_t* cells)
+{
+    switch (selectedKernel)
+    {
+        #ifdef SUDOKU_VALIDATOR_X86
+            case Kernel::Avx2:
+                return checkAvx2(cells);
+            case Kernel::Sse41:
+                return checkSse41(cells);
+        #endif
+        default:
+            return checkScalar(cells);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuValidator::checkBatch(const std::uint8_t* boards, std::size_t count, BoardCheck* results)
+{
+    switch (selectedKernel)
+    {
+        #ifdef SUDOKU_VALIDATOR_X86
+            case Kernel::Avx2:
+                return checkBatchAvx2(boards, count, results);
+            case Kernel::Sse41:
+                return checkBatchSse41(boards, count, results);
+        #endif
+        default:
+            return checkBatchScalar(boards, count, results);
+    }
+}
+
+//------------------------------------------------------------------------------------------
+
+SudokuValidator::Kernel SudokuValidator::activeKernel()
+{
+    return selectedKernel;
+}
+
+//------------------------------------------------------------------------------------------
+
+void SudokuValidator::setKernel(Kernel kernel)
+{
+    selectedKernel = isSupported(kernel) ? kernel : Kernel::Scalar;
+}
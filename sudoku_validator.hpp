@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------
+
+struct BoardCheck
+{
+    // No row, column or box holds the same digit twice
+    bool valid = false;
+    // No cell is empty
+    bool full = false;
+
+    bool done() const { return valid && full; }
+};
+
+//------------------------------------------------------------------------------------------
+
+// Checks every row, column and box of a 9x9 board at once. Boards are 81 row-major values
+// between 0 (empty) and 9. On x86 the check runs as an SSE4.1 or AVX2 kernel picked at
+// runtime, with the scalar path as the fallback; all three give identical results.
+
+class SudokuValidator
+{
+public:
+    enum class Kernel
+    {
+        Scalar,
+        Sse41,
+        Avx2,
+    };
+
+    static BoardCheck check(const std::uint8_t* cells);
+
+    // Checks count boards stored back to back, 81 bytes each
+    static void checkBatch(const std::uint8_t* boards, std::size_t count, BoardCheck* results);
+
+    // Kernel picked for this CPU
+    static Kernel activeKernel();
+
+    // Forces a kernel, falling back to scalar if the CPU lacks it; mainly for testing
+    static void setKernel(Kernel);
+
+    static constexpr std::size_t BoardSize = 81;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <utility>
+
+//------------------------------------------------------------------------------------------
+
+// Per-worker queue that idle workers steal from. The owner takes the oldest item, so a
+// stream of work still completes roughly in submission order, while thieves take from the
+// other end to stay out of the owner's way.
+
+template <typename T>
+class WorkStealingQueue
+{
+public:
+    void push(T item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(std::move(item));
+    }
+
+    // Returns true if the owning worker took an item
+    bool pop(T& item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (items.empty())
+        {
+            return false;
+        }
+
+        item = std::move(items.front());
+        items.pop_front();
+        return true;
+    }
+
+    // Returns true if another worker took an item
+    bool steal(T& item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (items.empty())
+        {
+            return false;
+        }
+
+        item = std::move(items.back());
+        items.pop_back();
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::deque<T> items;
+};